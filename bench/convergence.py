@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""Convergence and efficiency benchmark for exponential vs power-series transmittance.
+
+Builds the renderer, renders a reference of every scene with
+--estimator reference, then renders the scene with both estimators at several
+sample counts with independent seeds. The reference marches the same segments
+as both estimators but integrates each segment's optical depth finely, so it
+is the exact transmittance the power-series estimator is unbiased for and
+depends on neither estimator. For each (scene, estimator, spp) it reports RMSE,
+signed bias and per-pixel variance against the reference, wall-clock time per render,
+and the efficiencies 1 / (variance * time) and 1 / (MSE * time).
+
+Compiler and libraries come from CXX, CXXFLAGS and EXR_LIBS, e.g.
+    CXXFLAGS="-O3 -std=c++17 -march=native" python3 bench/convergence.py
+"""
+
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+import time
+
+SCENES = ["cloud", "homoradiance", "radiance"]
+ESTIMATORS = ["exponential", "power"]
+
+
+def build(src_dir, build_dir, name):
+    cxx = os.environ.get("CXX", "g++")
+    cxxflags = shlex.split(os.environ.get("CXXFLAGS", "-O2 -std=c++17"))
+    libs = shlex.split(os.environ.get("EXR_LIBS", "-lOpenEXR -lImath -lIex"))
+    exe = os.path.join(build_dir, name)
+    cmd = [cxx, *cxxflags, "-I", src_dir, os.path.join(src_dir, name + ".cpp"),
+           "-o", exe, "-pthread", *libs]
+    print("build:", " ".join(cmd), file=sys.stderr)
+    subprocess.run(cmd, check=True)
+    return exe
+
+
+def render(exe, scene, estimator, spp, seed, output):
+    start = time.perf_counter()
+    subprocess.run([exe, scene, "--estimator", estimator, "--spp", str(spp),
+                    "--seed", str(seed), "--output", output],
+                   check=True, stdout=subprocess.DEVNULL)
+    return time.perf_counter() - start
+
+
+def compare(compare_exe, reference, images):
+    out = subprocess.run([compare_exe, reference, *images], check=True,
+                         capture_output=True, text=True).stdout
+    return json.loads(out)
+
+
+def efficiency(error, seconds):
+    return 1.0 / (error * seconds) if error > 0 else None
+
+
+def plot(results, out_dir):
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print("matplotlib not available, skipping plots", file=sys.stderr)
+        return
+
+    for scene, variants in results.items():
+        fig, axes = plt.subplots(1, 2, figsize=(10, 4))
+        for variant, rows in variants.items():
+            spp = [r["spp"] for r in rows]
+            axes[0].loglog(spp, [r["rmse"] for r in rows], "o-", label=variant)
+            eff = [(r["spp"], r["mse_efficiency"]) for r in rows if r["mse_efficiency"]]
+            if eff:
+                axes[1].loglog(*zip(*eff), "o-", label=variant)
+        axes[0].set_xlabel("spp")
+        axes[0].set_ylabel("RMSE")
+        axes[1].set_xlabel("spp")
+        axes[1].set_ylabel("1 / (MSE x time)")
+        for ax in axes:
+            ax.legend()
+            ax.grid(True, which="both", alpha=0.3)
+        fig.suptitle(scene)
+        fig.tight_layout()
+        path = os.path.join(out_dir, scene + ".png")
+        fig.savefig(path)
+        plt.close(fig)
+        print("plot:", path, file=sys.stderr)
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--src", default=os.path.join(root, "src"))
+    parser.add_argument("--scene-dir", default=os.path.join(root, "scenes"))
+    parser.add_argument("--out", default=os.path.join(root, "bench", "results"))
+    parser.add_argument("--scenes", nargs="+", default=SCENES, choices=SCENES)
+    parser.add_argument("--spp", nargs="+", type=int, default=[1, 2, 4, 8])
+    parser.add_argument("--runs", type=int, default=4,
+                        help="independent seeds per sample count")
+    args = parser.parse_args()
+
+    build_dir = os.path.join(args.out, "bin")
+    image_dir = os.path.join(args.out, "images")
+    os.makedirs(build_dir, exist_ok=True)
+    os.makedirs(image_dir, exist_ok=True)
+
+    compare_exe = build(args.src, build_dir, "compare_exr")
+    render_exe = build(args.src, build_dir, "render")
+
+    results = {}
+    for scene in args.scenes:
+        scene_file = os.path.join(args.scene_dir, scene + ".scene")
+        reference = os.path.join(image_dir, scene + "_reference.exr")
+        seconds = render(render_exe, scene_file, "reference", 1, 1000003, reference)
+        print(f"{scene}: reference in {seconds:.1f}s", file=sys.stderr)
+
+        results[scene] = {}
+        for estimator in ESTIMATORS:
+            rows = []
+            for spp in args.spp:
+                images = []
+                total = 0.0
+                for run in range(args.runs):
+                    image = os.path.join(image_dir, f"{scene}_{estimator}_{spp}spp_{run}.exr")
+                    total += render(render_exe, scene_file, estimator, spp, run + 1, image)
+                    images.append(image)
+                seconds = total / args.runs
+                stats = compare(compare_exe, reference, images)
+                row = {
+                    "spp": spp,
+                    "runs": args.runs,
+                    "seconds": seconds,
+                    "rmse": stats["rmse"],
+                    "bias": stats["bias"],
+                    "variance": stats["variance"],
+                    "efficiency": efficiency(stats["variance"], seconds),
+                    "mse_efficiency": efficiency(stats["rmse"] ** 2, seconds),
+                }
+                rows.append(row)
+                print(f"{scene} {estimator}: {json.dumps(row)}", file=sys.stderr)
+            results[scene][estimator] = rows
+
+    path = os.path.join(args.out, "convergence.json")
+    with open(path, "w") as f:
+        json.dump({"scenes": results}, f, indent=2)
+    print("results:", path, file=sys.stderr)
+    plot(results, args.out)
+
+
+if __name__ == "__main__":
+    main()
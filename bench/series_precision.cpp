@@ -0,0 +1,162 @@
+// Accuracy and speed of compute_T by series length.
+//
+// Each trial draws comb estimates X[i] = -tau * 2u, u uniform in [0, 1), so
+// the combs scatter as widely as they do in heterogeneous media, and the
+// roulette weights Q[i] that transEstimator would produce. It then compares
+// the current kernel with the previous all-float Newton-identity kernel,
+// both against a long double evaluation of the same series.
+//
+//   g++ -O3 -std=c++17 -I src bench/series_precision.cpp -o series_precision
+//   ./series_precision [trials]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "power_series.h"
+#include "pcg.h"
+
+struct Series {
+    float X[kMaxSeriesTerms];
+    float Q[kMaxSeriesTerms];
+};
+
+std::vector<Series> makeSeries(int N_plus_1, float tau, int trials, uint64_t seed) {
+    const float K = 2;
+    const float c = 2.5;
+    std::vector<Series> series(trials);
+    UniformRandom float_rng(seed, N_plus_1, 0.0f, 1.0f);
+    for (Series& s : series) {
+        float q_i = 1;
+        for (int i = 0; i < N_plus_1; i++) {
+            s.X[i] = -tau * 2.0f * float_rng.next_float();
+            if (i > K) q_i *= c / i;
+            s.Q[i] = q_i;
+        }
+    }
+    return series;
+}
+
+// The kernel compute_T used before: float power sums fed through the
+// alternating Newton identities.
+float f_N_newton(float p, const float* Y, int N, const float* Q) {
+    float shiftedY[kMaxSeriesTerms];
+    float powY[kMaxSeriesTerms];
+    for (int i = 0; i < N; i++) {
+        shiftedY[i] = Y[i] - p;
+        powY[i] = 1.0f;
+    }
+
+    float P[kMaxSeriesTerms];
+    for (int i = 0; i < N; i++) {
+        float sum = 0;
+        for (int j = 0; j < N; j++) {
+            powY[j] *= shiftedY[j];
+            sum += powY[j];
+        }
+        P[i] = sum;
+    }
+
+    float S[kMaxSeriesTerms];
+    for (int i = 0; i < N; i++) {
+        float sum = 0;
+        int coef = 1;
+        for (int j = 0; j < i; j++) {
+            sum += coef * S[i-1-j] * P[j];
+            coef *= -1;
+        }
+        sum += coef * P[i];
+        S[i] = sum / (i + 1);
+    }
+
+    float f = 1.0f / Q[0];
+    float denom = 1.0f;
+    for (int i = 0; i < N; i++) {
+        denom *= (N - i);
+        f += S[i] / (denom * Q[i+1]);
+    }
+
+    return std::exp(p) * f;
+}
+
+float compute_T_newton(const float* X, const float* Q, int N_plus_1) {
+    float T_sum = 0.0f;
+    for (int i = 0; i < N_plus_1; i++) {
+        BoundedArray<float, kMaxSeriesTerms> Y;
+        for (int j = 0; j < N_plus_1; ++j) {
+            if (j != i) Y.push_back(X[j]);
+        }
+        T_sum += f_N_newton(X[i], Y.data(), Y.size(), Q);
+    }
+    return T_sum / N_plus_1;
+}
+
+long double compute_T_reference(const float* X, const float* Q, int N_plus_1) {
+    long double T_sum = 0;
+    for (int i = 0; i < N_plus_1; i++) {
+        long double e[kMaxSeriesTerms + 1] = {1};
+        int N = 0;
+        for (int j = 0; j < N_plus_1; j++) {
+            if (j == i) continue;
+            long double shiftedY = (long double)X[j] - X[i];
+            N++;
+            for (int k = N; k >= 1; k--) {
+                e[k] += shiftedY * e[k-1];
+            }
+        }
+        long double f = 1.0L / Q[0];
+        long double denom = 1;
+        for (int k = 0; k < N; k++) {
+            denom *= (N - k);
+            f += e[k+1] / (denom * Q[k+1]);
+        }
+        T_sum += std::exp((long double)X[i]) * f;
+    }
+    return T_sum / N_plus_1;
+}
+
+void measure(const char* name, float (*kernel)(const float*, const float*, int),
+             const std::vector<Series>& series, int N_plus_1,
+             const std::vector<long double>& reference) {
+    std::vector<float> results(series.size());
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < series.size(); k++) {
+        results[k] = kernel(series[k].X, series[k].Q, N_plus_1);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count() / series.size();
+
+    double maxError = 0;
+    double sumError = 0;
+    for (size_t k = 0; k < series.size(); k++) {
+        double error = std::fabs((double)((results[k] - reference[k]) / reference[k]));
+        if (!std::isfinite(error)) error = INFINITY;
+        maxError = std::fmax(maxError, error);
+        sumError += error;
+    }
+    std::printf("  %-8s %10.1f ns %12.3e mean %12.3e max\n",
+                name, ns, sumError / series.size(), maxError);
+}
+
+int main(int argc, char** argv) {
+    int trials = argc > 1 ? std::atoi(argv[1]) : 20000;
+    const int lengths[] = {3, 6, 10, 17, 24, 32, 40};
+    const float taus[] = {0.5f, 2.0f, 8.0f};
+
+    std::printf("relative error of compute_T against long double\n");
+    for (float tau : taus) {
+        for (int N_plus_1 : lengths) {
+            std::vector<Series> series = makeSeries(N_plus_1, tau, trials, 42);
+            std::vector<long double> reference(series.size());
+            for (size_t k = 0; k < series.size(); k++) {
+                reference[k] = compute_T_reference(series[k].X, series[k].Q, N_plus_1);
+            }
+
+            std::printf("tau %.1f, %d comb estimates\n", tau, N_plus_1);
+            measure("previous", compute_T_newton, series, N_plus_1, reference);
+            measure("current", compute_T, series, N_plus_1, reference);
+        }
+    }
+    return 0;
+}
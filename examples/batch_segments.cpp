@@ -0,0 +1,25 @@
+// Second translation unit of the batch example; including batch_trans.h
+// here as well checks that the library links into more than one file.
+
+#include <cmath>
+#include <vector>
+#include "batch_trans.h"
+
+// Radial density 0.5 exp(-|p|), as in comb.h. A segment from the origin to
+// distance L has optical depth 0.5 (1 - exp(-L)).
+float radialDensity(const Vec3 p) {
+    return 0.5f * std::exp(-p.length());
+}
+
+std::vector<Segment> makeSegments(size_t count, float length, std::vector<float>& expected) {
+    std::vector<Segment> segments(count);
+    expected.resize(count);
+    for (size_t k = 0; k < count; k++) {
+        float angle = 2.0f * 3.14159265f * k / count;
+        Vec3 dir(std::cos(angle), std::sin(angle), 0.0f);
+        segments[k] = {Vec3(), dir * length};
+        float tau = 0.5f * (1.0f - std::exp(-length));
+        expected[k] = std::exp(-tau);
+    }
+    return segments;
+}
@@ -0,0 +1,50 @@
+// Minimal use of BatchTransEstimator: estimates transmittance along many
+// segments with a known optical depth, checks that the mean matches
+// exp(-tau) and that the estimates do not depend on the thread count.
+//
+//   g++ -O2 -std=c++17 -I src examples/batch_trans.cpp examples/batch_segments.cpp -o batch_trans -pthread
+//   ./batch_trans
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#define ALLOC_TRACKER_IMPLEMENTATION
+#include "batch_trans.h"
+
+float radialDensity(const Vec3 p);
+std::vector<Segment> makeSegments(size_t count, float length, std::vector<float>& expected);
+
+int main() {
+    const size_t count = 100000;
+    std::vector<float> expected;
+    std::vector<Segment> segments = makeSegments(count, 3.0f, expected);
+
+    std::vector<float> single(count);
+    std::vector<float> pooled(count);
+    {
+        BatchTransEstimator estimator(1, 42);
+        estimator.estimate(segments.data(), count, radialDensity, single.data());
+    }
+    {
+        BatchTransEstimator estimator(4, 42);
+        estimator.estimate(segments.data(), count, radialDensity, pooled.data());
+    }
+
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    size_t mismatches = 0;
+    for (size_t k = 0; k < count; k++) {
+        double error = (double)single[k] - expected[k];
+        sum += error;
+        sumSquares += error * error;
+        if (single[k] != pooled[k]) mismatches++;
+    }
+    double bias = sum / count;
+    double standardError = std::sqrt((sumSquares / count - bias * bias) / count);
+
+    std::printf("T = %.6f, mean estimate %.6f +- %.6f, thread mismatches %zu\n",
+                expected[0], expected[0] + bias, standardError, mismatches);
+    bool ok = std::fabs(bias) < 4.0 * standardError && mismatches == 0;
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+// Heap allocation tracking for the render hot path. Build with
+// -DTRACK_ALLOCATIONS to count allocations per thread; ALLOCATION_FREE_SCOPE
+// then aborts if its scope allocates. Otherwise it compiles to nothing.
+// The counting operator new and delete replace the global ones and must be
+// defined once per program: define ALLOC_TRACKER_IMPLEMENTATION before
+// including this header in exactly one translation unit.
+
+#ifdef TRACK_ALLOCATIONS
+
+#ifdef ENABLE_PROFILING
+#error "TRACK_ALLOCATIONS cannot be combined with ENABLE_PROFILING, which allocates as it records"
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+extern thread_local unsigned long long threadAllocationCount;
+
+#ifdef ALLOC_TRACKER_IMPLEMENTATION
+
+thread_local unsigned long long threadAllocationCount = 0;
+
+// noinline keeps GCC from pairing the malloc inside operator new with the
+// free inside operator delete and warning about a mismatch.
+__attribute__((noinline)) void* operator new(std::size_t size) {
+    threadAllocationCount++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+#endif
+
+class AllocationFreeScope {
+public:
+    explicit AllocationFreeScope(const char* name)
+        : name(name), start(threadAllocationCount) {}
+    ~AllocationFreeScope() {
+        unsigned long long count = threadAllocationCount - start;
+        if (count != 0) {
+            std::fprintf(stderr, "%llu heap allocation(s) in allocation-free scope '%s'\n",
+                         count, name);
+            std::abort();
+        }
+    }
+
+private:
+    const char* name;
+    unsigned long long start;
+};
+
+#define ALLOCATION_CONCAT_INNER(a, b) a##b
+#define ALLOCATION_CONCAT(a, b) ALLOCATION_CONCAT_INNER(a, b)
+#define ALLOCATION_FREE_SCOPE(name) \
+    AllocationFreeScope ALLOCATION_CONCAT(allocationFreeScope_, __LINE__)(name)
+
+#else
+
+#define ALLOCATION_FREE_SCOPE(name) ((void)0)
+
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "vector.h"
+#include "estimate_trans.h"
+#include "pcg.h"
+#include "alloc_tracker.h"
+#include "worker_pool.h"
+
+struct Segment {
+    Vec3 start;
+    Vec3 end;
+};
+
+// Estimates transmittance for many segments at once on the shared worker
+// pool. Each segment draws from its own pcg stream keyed by (seed, call,
+// index), so results do not depend on the thread count or scheduling, and a
+// call performs no heap allocation once the pool is running.
+class BatchTransEstimator {
+public:
+    explicit BatchTransEstimator(int numThreads = std::thread::hardware_concurrency(),
+                                 uint64_t seed = 42)
+        : seed(seed), numThreads(std::max(numThreads, 1)), generation(0) {}
+
+    int threadCount() const { return numThreads; }
+
+    // Writes one unbiased transmittance estimate per segment to out[0..count).
+    // The pool runs one batch at a time; concurrent callers are serialized.
+    void estimate(const Segment* segments, size_t count,
+                  float (*getDensity)(const Vec3), float* out) {
+        std::lock_guard<std::mutex> call(callMutex);
+        uint64_t stream_base = generation++ << 40;
+        int chunks = (count + kChunkSize - 1) / kChunkSize;
+        parallelFor(chunks, numThreads, [&](int chunk) {
+            ALLOCATION_FREE_SCOPE("batch chunk");
+            size_t begin = chunk * kChunkSize;
+            size_t end = std::min(begin + kChunkSize, count);
+            for (size_t k = begin; k < end; k++) {
+                UniformRandom float_rng(seed, stream_base + k, 0.0f, 1.0f);
+                out[k] = transEstimator(segments[k].start, segments[k].end,
+                                        getDensity, float_rng);
+            }
+        });
+    }
+
+private:
+    static const size_t kChunkSize = 64;
+
+    uint64_t seed;
+    int numThreads;
+    uint64_t generation;
+    std::mutex callMutex;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cassert>
+
+// Fixed-capacity array with vector-like push_back, kept on the stack so hot
+// loops never touch the heap. Pushing past Capacity is a logic error.
+template <typename T, int Capacity>
+class BoundedArray {
+public:
+    void push_back(const T& value) {
+        assert(count < Capacity);
+        items[count++] = value;
+    }
+
+    bool full() const { return count == Capacity; }
+    int size() const { return count; }
+    const T* data() const { return items; }
+    T& operator[](int i) { return items[i]; }
+    const T& operator[](int i) const { return items[i]; }
+
+private:
+    T items[Capacity];
+    int count = 0;
+};
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "vector.h"
+#include "render_args.h"
+#include "denoise.h"
+
+const char kCheckpointMagic[8] = {'U', 'T', 'E', 'C', 'K', 'P', 'T', '4'};
+
+// Everything needed to continue a render bit-identically. Rows before nextRow
+// are final, and every sample draws from pixelRandom(seed, pixel, sample), so
+// no RNG state has to be carried over. The fingerprint identifies the scene
+// and the remaining options that change pixel values.
+struct RenderCheckpoint {
+    int width = 0;
+    int height = 0;
+    int spp = 0;
+    uint64_t seed = 0;
+    uint64_t fingerprint = 0;
+    int shardIndex = 0;
+    int shardCount = 1;
+    int shardBySamples = 0;
+    int nextRow = 0;
+    std::vector<Vec4> pixels;
+    std::vector<DenoiseGuide> guides;
+
+    bool matches(const RenderCheckpoint& other) const {
+        return width == other.width && height == other.height && spp == other.spp &&
+               seed == other.seed && fingerprint == other.fingerprint &&
+               shardIndex == other.shardIndex &&
+               shardCount == other.shardCount && shardBySamples == other.shardBySamples;
+    }
+};
+
+// FNV-1a over raw bytes.
+uint64_t fingerprintBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t k = 0; k < size; k++) {
+        hash = (hash ^ bytes[k]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+uint64_t fingerprintFile(uint64_t hash, const char* filename) {
+    std::ifstream in(filename, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    hash = fingerprintBytes(hash, contents.data(), contents.size());
+    // Separates "no file" from an empty one.
+    return fingerprintBytes(hash, "", 1);
+}
+
+// Scene file and light rig contents plus the options that change what a
+// sample computes. Threads, output paths and --denoise, which only filters
+// the finished image, are left out.
+uint64_t renderFingerprint(const RenderArgs& args) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    if (args.scene) hash = fingerprintFile(hash, args.scene);
+    if (args.lights) hash = fingerprintFile(hash, args.lights);
+    int estimator = (int)args.estimator;
+    hash = fingerprintBytes(hash, &estimator, sizeof(estimator));
+    hash = fingerprintBytes(hash, &args.shadowStride, sizeof(args.shadowStride));
+    hash = fingerprintBytes(hash, &args.radialTable, sizeof(args.radialTable));
+    return hash;
+}
+
+RenderCheckpoint makeCheckpoint(const RenderArgs& args, int width, int height) {
+    RenderCheckpoint ckpt;
+    ckpt.width = width;
+    ckpt.height = height;
+    ckpt.spp = args.spp;
+    ckpt.seed = args.seed;
+    ckpt.fingerprint = renderFingerprint(args);
+    ckpt.shardIndex = args.shard.index;
+    ckpt.shardCount = args.shard.count;
+    ckpt.shardBySamples = args.shard.bySamples;
+    return ckpt;
+}
+
+bool saveCheckpoint(const RenderCheckpoint& ckpt, const char* filename) {
+    // Write beside the target and rename, so a kill mid-write leaves the
+    // previous checkpoint intact.
+    std::string tmpName = std::string(filename) + ".tmp";
+    {
+        std::ofstream out(tmpName, std::ios::binary);
+        if (!out) {
+            std::cerr << "Failed to write checkpoint: " << tmpName << std::endl;
+            return false;
+        }
+        out.write(kCheckpointMagic, sizeof(kCheckpointMagic));
+        out.write(reinterpret_cast<const char*>(&ckpt.width), sizeof(ckpt.width));
+        out.write(reinterpret_cast<const char*>(&ckpt.height), sizeof(ckpt.height));
+        out.write(reinterpret_cast<const char*>(&ckpt.spp), sizeof(ckpt.spp));
+        out.write(reinterpret_cast<const char*>(&ckpt.seed), sizeof(ckpt.seed));
+        out.write(reinterpret_cast<const char*>(&ckpt.fingerprint), sizeof(ckpt.fingerprint));
+        out.write(reinterpret_cast<const char*>(&ckpt.shardIndex), sizeof(ckpt.shardIndex));
+        out.write(reinterpret_cast<const char*>(&ckpt.shardCount), sizeof(ckpt.shardCount));
+        out.write(reinterpret_cast<const char*>(&ckpt.shardBySamples), sizeof(ckpt.shardBySamples));
+        out.write(reinterpret_cast<const char*>(&ckpt.nextRow), sizeof(ckpt.nextRow));
+        out.write(reinterpret_cast<const char*>(ckpt.pixels.data()),
+                  ckpt.pixels.size() * sizeof(Vec4));
+        uint64_t guideCount = ckpt.guides.size();
+        out.write(reinterpret_cast<const char*>(&guideCount), sizeof(guideCount));
+        out.write(reinterpret_cast<const char*>(ckpt.guides.data()),
+                  guideCount * sizeof(DenoiseGuide));
+        if (!out) {
+            std::cerr << "Failed to write checkpoint: " << tmpName << std::endl;
+            return false;
+        }
+    }
+    if (std::rename(tmpName.c_str(), filename) != 0) {
+        std::cerr << "Failed to replace checkpoint: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool loadCheckpoint(RenderCheckpoint& ckpt, const char* filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        std::cerr << "Failed to open checkpoint: " << filename << std::endl;
+        return false;
+    }
+    char magic[sizeof(kCheckpointMagic)];
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&ckpt.width), sizeof(ckpt.width));
+    in.read(reinterpret_cast<char*>(&ckpt.height), sizeof(ckpt.height));
+    in.read(reinterpret_cast<char*>(&ckpt.spp), sizeof(ckpt.spp));
+    in.read(reinterpret_cast<char*>(&ckpt.seed), sizeof(ckpt.seed));
+    in.read(reinterpret_cast<char*>(&ckpt.fingerprint), sizeof(ckpt.fingerprint));
+    in.read(reinterpret_cast<char*>(&ckpt.shardIndex), sizeof(ckpt.shardIndex));
+    in.read(reinterpret_cast<char*>(&ckpt.shardCount), sizeof(ckpt.shardCount));
+    in.read(reinterpret_cast<char*>(&ckpt.shardBySamples), sizeof(ckpt.shardBySamples));
+    in.read(reinterpret_cast<char*>(&ckpt.nextRow), sizeof(ckpt.nextRow));
+    if (!in || std::string(magic, sizeof(magic)) != std::string(kCheckpointMagic, sizeof(magic))
+        || ckpt.width <= 0 || ckpt.height <= 0) {
+        std::cerr << "Invalid checkpoint: " << filename << std::endl;
+        return false;
+    }
+    ckpt.pixels.resize((size_t)ckpt.width * ckpt.height);
+    in.read(reinterpret_cast<char*>(ckpt.pixels.data()), ckpt.pixels.size() * sizeof(Vec4));
+    uint64_t guideCount = 0;
+    in.read(reinterpret_cast<char*>(&guideCount), sizeof(guideCount));
+    if (!in || (guideCount != 0 && guideCount != ckpt.pixels.size())) {
+        std::cerr << "Invalid checkpoint: " << filename << std::endl;
+        return false;
+    }
+    ckpt.guides.resize(guideCount);
+    in.read(reinterpret_cast<char*>(ckpt.guides.data()), guideCount * sizeof(DenoiseGuide));
+    if (!in) {
+        std::cerr << "Truncated checkpoint: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Restores pixels, denoiser guides (when given) and the start row from
+// args.checkpoint after checking the checkpoint belongs to the same render
+// job (size, spp, seed, shard, scene and render options).
+bool resumeCheckpoint(const RenderArgs& args, int width, int height,
+                      std::vector<Vec4>& pixels, int& startRow,
+                      std::vector<DenoiseGuide>* guides = nullptr) {
+    RenderCheckpoint ckpt;
+    if (!loadCheckpoint(ckpt, args.checkpoint)) {
+        return false;
+    }
+    RenderCheckpoint expected = makeCheckpoint(args, width, height);
+    if (ckpt.fingerprint != expected.fingerprint) {
+        std::cerr << "Checkpoint " << args.checkpoint << " was written for a different scene,"
+                  << " light rig, estimator, --shadow-stride or --radial-table" << std::endl;
+        return false;
+    }
+    if (!ckpt.matches(expected)) {
+        std::cerr << "Checkpoint " << args.checkpoint << " was written for a "
+                  << ckpt.width << "x" << ckpt.height << " render with spp " << ckpt.spp
+                  << ", seed " << ckpt.seed << " and shard "
+                  << ckpt.shardIndex << "/" << ckpt.shardCount << std::endl;
+        return false;
+    }
+    if (guides && ckpt.guides.size() != guides->size()) {
+        std::cerr << "Checkpoint " << args.checkpoint << " has no denoiser guides" << std::endl;
+        return false;
+    }
+    pixels = std::move(ckpt.pixels);
+    if (guides) {
+        *guides = std::move(ckpt.guides);
+    }
+    startRow = ckpt.nextRow;
+    std::cout << "Resumed from " << args.checkpoint << " at row " << startRow << std::endl;
+    return true;
+}
+
+// Periodically snapshots the render state and writes it on a background
+// thread. If the previous write is still in flight the snapshot is skipped,
+// so the render thread never waits on disk.
+class CheckpointWriter {
+public:
+    CheckpointWriter(const RenderArgs& args, int width, int height)
+        : filename(args.checkpoint), interval(args.checkpointInterval),
+          lastSave(std::chrono::steady_clock::now()),
+          snapshot(makeCheckpoint(args, width, height)),
+          busy(false), stopping(false) {
+        if (filename) {
+            worker = std::thread(&CheckpointWriter::run, this);
+        }
+    }
+
+    ~CheckpointWriter() {
+        if (!worker.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_one();
+        worker.join();
+    }
+
+    // Call as rows complete; every row before nextRow must be final. Only
+    // those rows are copied, so other threads may still be writing later
+    // rows. Safe to call from several render threads.
+    void maybeSave(int nextRow, const std::vector<Vec4>& pixels,
+                   const std::vector<DenoiseGuide>* guides = nullptr) {
+        if (!filename) return;
+        std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock() || busy || nextRow <= snapshot.nextRow) return;
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - lastSave).count() < interval) return;
+
+        size_t done = (size_t)nextRow * snapshot.width;
+        snapshot.nextRow = nextRow;
+        snapshot.pixels.resize(pixels.size());
+        std::copy(pixels.begin(), pixels.begin() + done, snapshot.pixels.begin());
+        if (guides) {
+            snapshot.guides.resize(guides->size());
+            std::copy(guides->begin(), guides->begin() + done, snapshot.guides.begin());
+        }
+        busy = true;
+        lastSave = now;
+        lock.unlock();
+        cv.notify_one();
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [this] { return busy || stopping; });
+            if (busy) {
+                // The render thread never touches the snapshot while busy.
+                lock.unlock();
+                saveCheckpoint(snapshot, filename);
+                lock.lock();
+                busy = false;
+            }
+            if (stopping) return;
+        }
+    }
+
+    const char* filename;
+    double interval;
+    std::chrono::steady_clock::time_point lastSave;
+    RenderCheckpoint snapshot;
+    bool busy;
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread worker;
+};
@@ -7,11 +7,11 @@
 #include "vector.h"
 #include "pcg.h"
 
-float evaluateDensity(Vec3 p) {
+inline float evaluateDensity(Vec3 p) {
     return 0.5f * std::exp(-p.length());
 }
 
-float combEstimator(Vec3 start_pos, Vec3 end_pos, 
+inline float combEstimator(Vec3 start_pos, Vec3 end_pos, 
                     int M, float (*getDensity)(Vec3),
                     UniformRandom& float_rng) {
     float L = (end_pos - start_pos).length();
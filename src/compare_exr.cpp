@@ -0,0 +1,70 @@
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "vector.h"
+#include "load_exr.h"
+
+// Compares independent renders against a reference image and prints
+// RMSE, signed bias and per-pixel variance across the renders as JSON.
+// Usage: compare_exr reference.exr run0.exr [run1.exr ...]
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " reference.exr run0.exr [run1.exr ...]" << std::endl;
+        return 1;
+    }
+
+    std::vector<Vec4> reference;
+    int width, height;
+    if (!loadEXR(argv[1], reference, width, height)) {
+        return 1;
+    }
+
+    int runs = argc - 2;
+    std::vector<std::vector<Vec4>> images(runs);
+    for (int r = 0; r < runs; r++) {
+        int w, h;
+        if (!loadEXR(argv[r + 2], images[r], w, h)) {
+            return 1;
+        }
+        if (w != width || h != height) {
+            std::cerr << "Size mismatch: " << argv[r + 2] << std::endl;
+            return 1;
+        }
+    }
+
+    double squaredError = 0.0;
+    double bias = 0.0;
+    double variance = 0.0;
+    int numPixels = width * height;
+    for (int k = 0; k < numPixels; k++) {
+        const float ref[3] = {reference[k].x, reference[k].y, reference[k].z};
+        for (int c = 0; c < 3; c++) {
+            double mean = 0.0;
+            for (int r = 0; r < runs; r++) {
+                const Vec4& p = images[r][k];
+                double value = (c == 0) ? p.x : (c == 1) ? p.y : p.z;
+                mean += value;
+                squaredError += (value - ref[c]) * (value - ref[c]);
+            }
+            mean /= runs;
+            bias += mean - ref[c];
+
+            if (runs > 1) {
+                double sum = 0.0;
+                for (int r = 0; r < runs; r++) {
+                    const Vec4& p = images[r][k];
+                    double value = (c == 0) ? p.x : (c == 1) ? p.y : p.z;
+                    sum += (value - mean) * (value - mean);
+                }
+                variance += sum / (runs - 1);
+            }
+        }
+    }
+
+    double samples = 3.0 * numPixels;
+    std::printf("{\"pixels\": %d, \"runs\": %d, \"rmse\": %.9g, \"bias\": %.9g, \"variance\": %.9g}\n",
+                numPixels, runs, std::sqrt(squaredError / (samples * runs)),
+                bias / samples, variance / samples);
+    return 0;
+}
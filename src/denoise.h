@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "vector.h"
+#include "profiler.h"
+#include "worker_pool.h"
+
+// Per-pixel guides gathered while rendering: the variance of the pixel's
+// mean luminance and its mean opacity (1 - transmittance). The variance
+// comes from the pixel's own samples, so denoising needs at least two.
+struct DenoiseGuide {
+    float variance;
+    float alpha;
+};
+
+// Runs fn(x0, y0, x1, y1) over tileSize x tileSize tiles on numThreads threads.
+template <typename Fn>
+void parallelTiles(int width, int height, int tileSize, int numThreads, Fn fn) {
+    int tilesX = (width + tileSize - 1) / tileSize;
+    int tilesY = (height + tileSize - 1) / tileSize;
+    parallelFor(tilesX * tilesY, numThreads, [&](int tile) {
+        int x0 = (tile % tilesX) * tileSize;
+        int y0 = (tile / tilesX) * tileSize;
+        fn(x0, y0, std::min(x0 + tileSize, width), std::min(y0 + tileSize, height));
+    });
+}
+
+// Edge-aware a-trous wavelet filter. Each pass applies a 5x5 B3-spline
+// kernel with holes of 2^pass pixels. Neighbour weights fall off with the
+// colour difference relative to the pixel's luminance standard deviation,
+// and with the opacity difference, so converged pixels and silhouettes stay sharp.
+// The variance is filtered alongside the colour so later passes grow less
+// aggressive as noise drops.
+void denoiseATrous(std::vector<Vec4>& pixels, const std::vector<DenoiseGuide>& guides,
+                   int width, int height, int passes = 5,
+                   int numThreads = std::thread::hardware_concurrency()) {
+    PROFILE_SCOPE("denoise");
+    const float kernel[3] = {3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f};
+    const float sigmaColor = 4.0f;
+    const float sigmaAlpha = 0.1f;
+    const float epsilon = 1e-6f;
+    const int tileSize = 32;
+    numThreads = std::max(numThreads, 1);
+
+    std::vector<Vec4> color = pixels;
+    std::vector<Vec4> colorOut(pixels.size());
+    std::vector<float> variance(guides.size());
+    std::vector<float> varianceOut(guides.size());
+    for (size_t k = 0; k < guides.size(); k++) {
+        variance[k] = guides[k].variance;
+    }
+
+    for (int pass = 0; pass < passes; pass++) {
+        int step = 1 << pass;
+        parallelTiles(width, height, tileSize, numThreads,
+                      [&](int x0, int y0, int x1, int y1) {
+            for (int y = y0; y < y1; y++) {
+                for (int x = x0; x < x1; x++) {
+                    int p = y * width + x;
+                    float ap = guides[p].alpha;
+                    float colorScale = sigmaColor * std::sqrt(variance[p]) + epsilon;
+
+                    Vec4 sum;
+                    float weightSum = 0.0f;
+                    float varianceSum = 0.0f;
+                    for (int dy = -2; dy <= 2; dy++) {
+                        int qy = y + dy * step;
+                        if (qy < 0 || qy >= height) continue;
+                        for (int dx = -2; dx <= 2; dx++) {
+                            int qx = x + dx * step;
+                            if (qx < 0 || qx >= width) continue;
+                            int q = qy * width + qx;
+                            float colorDistance = (std::fabs(color[p].x - color[q].x)
+                                                   + std::fabs(color[p].y - color[q].y)
+                                                   + std::fabs(color[p].z - color[q].z)) / 3.0f;
+                            float w = kernel[std::abs(dx)] * kernel[std::abs(dy)]
+                                      * std::exp(-colorDistance / colorScale
+                                                 - std::fabs(ap - guides[q].alpha) / sigmaAlpha);
+                            sum = Vec4(sum.x + w * color[q].x, sum.y + w * color[q].y,
+                                       sum.z + w * color[q].z, sum.w + w * color[q].w);
+                            weightSum += w;
+                            varianceSum += w * w * variance[q];
+                        }
+                    }
+                    float inv = 1.0f / weightSum;
+                    colorOut[p] = Vec4(sum.x * inv, sum.y * inv, sum.z * inv, sum.w * inv);
+                    varianceOut[p] = varianceSum * inv * inv;
+                }
+            }
+        });
+        std::swap(color, colorOut);
+        std::swap(variance, varianceOut);
+    }
+
+    pixels = std::move(color);
+}
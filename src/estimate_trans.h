@@ -8,31 +8,66 @@
 #include "vector.h"
 #include "comb.h"
 #include "power_series.h"
+#include "bounded_array.h"
 #include "pcg.h"
+#include "profiler.h"
 
-float transEstimator(Vec3 start_pos, Vec3 end_pos, 
-                     float (*getDensity)(const Vec3),
-                     UniformRandom& float_rng) {
-    int M = 12;
+// Draws the comb estimates X of one segment with nextComb(float_rng), ended
+// by a roulette after the first K + 1, and Q[k], the probability that X holds
+// at least k + 1 estimates.
+template <typename CombFn>
+inline void drawCombs(CombFn nextComb, UniformRandom& float_rng,
+                      BoundedArray<float, kMaxSeriesTerms>& X,
+                      BoundedArray<float, kMaxSeriesTerms>& Q) {
     float K = 2;
     float c = 2.5;
-    std::vector<float> X;
-    std::vector<float> Q;
     for (int i = 0; i < K + 1; i++) {
-        X.push_back(combEstimator(start_pos, end_pos, M, getDensity, float_rng));
+        X.push_back(nextComb(float_rng));
         Q.push_back(1);
     }
     float q_i = 1;
     int i = 1;
-    while (true) {
+    while (!X.full()) {
         float prob = c / (K + i);
         if (float_rng.next_float() > prob) {
             break;
         }
         q_i *= prob;
-        X.push_back(combEstimator(start_pos, end_pos, M, getDensity, float_rng));
+        X.push_back(nextComb(float_rng));
         Q.push_back(q_i);
         i++;
     }
-    return compute_T(X, Q);
-}
\ No newline at end of file
+}
+
+inline float transEstimator(Vec3 start_pos, Vec3 end_pos, 
+                            float (*getDensity)(const Vec3),
+                            UniformRandom& float_rng) {
+    PROFILE_SCOPE("transEstimator");
+    int M = 12;
+    BoundedArray<float, kMaxSeriesTerms> X;
+    BoundedArray<float, kMaxSeriesTerms> Q;
+    drawCombs([&](UniformRandom& rng) {
+        return combEstimator(start_pos, end_pos, M, getDensity, rng);
+    }, float_rng, X, Q);
+    return compute_T(X.data(), Q.data(), X.size());
+}
+
+// The same series expanded about a pivot fixed before the combs are drawn,
+// such as a tabulated estimate of the segment's negated optical depth. Every
+// comb then enters as a factor, so Q shifts by one term (K + 1 factors are
+// always present), and a single f_N call replaces compute_T's average over
+// each comb as pivot. Any pivot independent of the combs keeps the estimate
+// unbiased; a closer one only lowers its variance.
+template <typename CombFn>
+inline float pivotedTransEstimator(float pivot, CombFn nextComb, UniformRandom& float_rng) {
+    PROFILE_SCOPE("transEstimator");
+    BoundedArray<float, kMaxSeriesTerms> X;
+    BoundedArray<float, kMaxSeriesTerms> Q;
+    drawCombs(nextComb, float_rng, X, Q);
+    BoundedArray<float, kMaxSeriesTerms + 1> shiftedQ;
+    shiftedQ.push_back(1);
+    for (int k = 0; k < X.size(); k++) {
+        shiftedQ.push_back(Q[k]);
+    }
+    return f_N(pivot, X.data(), X.size(), shiftedQ.data());
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "vector.h"
+#include "pcg.h"
+
+enum class LightType { Directional, Point };
+
+// Point lights are treated as at least this far away, so a shading point on
+// the light does not divide by zero.
+const float kMinLightDistance = 1e-3f;
+
+// Directional lights store the direction towards the light; point lights
+// store a position and fall off with the inverse square of the distance.
+struct Light {
+    LightType type;
+    Vec3 direction;
+    Vec3 position;
+    Vec3 color;
+
+    static Light directional(const Vec3& towardsLight, const Vec3& color) {
+        return {LightType::Directional, towardsLight.normalized(), Vec3(), color};
+    }
+
+    static Light point(const Vec3& position, const Vec3& color) {
+        return {LightType::Point, Vec3(), position, color};
+    }
+
+    // Unit vector from p towards the light, and the distance to it.
+    Vec3 directionFrom(const Vec3& p, float& distance) const {
+        if (type == LightType::Directional) {
+            distance = std::numeric_limits<float>::infinity();
+            return direction;
+        }
+        Vec3 d = position - p;
+        distance = std::max(d.length(), kMinLightDistance);
+        return d * (1.0f / distance);
+    }
+
+    Vec3 radianceAt(float distance) const {
+        if (type == LightType::Directional) return color;
+        return color * (1.0f / (distance * distance));
+    }
+
+    float power() const {
+        return luminance(color);
+    }
+};
+
+// Parses the fields after a "directional" or "point" keyword.
+bool parseLight(const std::string& type, std::istream& fields, Light& light) {
+    Vec3 v, color;
+    if (!(fields >> v.x >> v.y >> v.z >> color.x >> color.y >> color.z) ||
+        (type != "directional" && type != "point")) {
+        return false;
+    }
+    light = type == "directional" ? Light::directional(v, color) : Light::point(v, color);
+    return true;
+}
+
+// Light selection needs some light with positive power; an all-black rig
+// would make every pixel NaN.
+bool rigHasPower(const std::vector<Light>& lights) {
+    for (const Light& light : lights) {
+        if (light.power() > 0.0f) return true;
+    }
+    return false;
+}
+
+// Reads one light per line:
+//   directional dx dy dz r g b
+//   point px py pz r g b
+// Blank lines and lines starting with '#' are ignored.
+bool loadLights(const char* filename, std::vector<Light>& lights) {
+    std::ifstream in(filename);
+    if (!in) {
+        std::cerr << "Failed to open light file: " << filename << std::endl;
+        return false;
+    }
+    lights.clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::istringstream fields(line);
+        std::string type;
+        if (!(fields >> type) || type[0] == '#') continue;
+
+        Light light;
+        if (!parseLight(type, fields, light)) {
+            std::cerr << filename << ":" << lineNumber << ": invalid light" << std::endl;
+            return false;
+        }
+        lights.push_back(light);
+    }
+    if (lights.empty()) {
+        std::cerr << "No lights in " << filename << std::endl;
+        return false;
+    }
+    if (!rigHasPower(lights)) {
+        std::cerr << "No light in " << filename << " has positive luminance" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Picks one light with probability proportional to its power, so the number
+// of shadow marches per step does not grow with the size of the rig. The rig
+// passed to build() must satisfy rigHasPower().
+class LightSampler {
+public:
+    void build(const std::vector<Light>& rig) {
+        lights = rig;
+        cdf.resize(lights.size());
+        float total = 0.0f;
+        for (size_t k = 0; k < lights.size(); k++) {
+            total += std::max(lights[k].power(), 0.0f);
+            cdf[k] = total;
+        }
+        for (float& c : cdf) {
+            c /= total;
+        }
+    }
+
+    const std::vector<Light>& all() const { return lights; }
+
+    // pdf receives the probability of the returned light. A lone light is
+    // returned without drawing, so one-light renders keep their random sequence.
+    const Light& sample(UniformRandom& float_rng, float& pdf) const {
+        if (lights.size() == 1) {
+            pdf = 1.0f;
+            return lights[0];
+        }
+        // next_float() can round up to exactly 1. Keeping u below cdf.back()
+        // makes upper_bound land on a light with positive power, never on a
+        // trailing zero-power light with pdf 0.
+        float u = std::min(float_rng.next_float(), std::nextafter(cdf.back(), 0.0f));
+        size_t k = std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+        pdf = cdf[k] - (k > 0 ? cdf[k - 1] : 0.0f);
+        return lights[k];
+    }
+
+private:
+    std::vector<Light> lights;
+    std::vector<float> cdf;
+};
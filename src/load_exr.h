@@ -0,0 +1,34 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <OpenEXR/ImfRgbaFile.h>
+#include <OpenEXR/ImfRgba.h>
+#include <OpenEXR/ImfArray.h>
+#include "vector.h"
+
+bool loadEXR(const char* filename, std::vector<Vec4>& pixels, int& width, int& height) {
+    try {
+        Imf::RgbaInputFile file(filename);
+        Imath::Box2i dw = file.dataWindow();
+        width = dw.max.x - dw.min.x + 1;
+        height = dw.max.y - dw.min.y + 1;
+
+        Imf::Array2D<Imf::Rgba> exrPixels;
+        exrPixels.resizeErase(height, width);
+        file.setFrameBuffer(&exrPixels[0][0] - dw.min.x - dw.min.y * width, 1, width);
+        file.readPixels(dw.min.y, dw.max.y);
+
+        pixels.resize(width * height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const Imf::Rgba& p = exrPixels[y][x];
+                pixels[y * width + x] = Vec4(p.r, p.g, p.b, p.a);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load EXR file: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
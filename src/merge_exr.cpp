@@ -0,0 +1,90 @@
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "vector.h"
+#include "save_exr.h"
+#include "partial_exr.h"
+
+// Combines partial renders written with --shard into one image, weighting
+// each shard's pixel by its sample count.
+// Usage: merge_exr [--partial] output.exr part0.exr [part1.exr ...]
+// With --partial the result keeps its spp channel, so merges can be nested.
+int main(int argc, char** argv) {
+    int first = 1;
+    bool keepPartial = false;
+    if (argc > 1 && std::strcmp(argv[1], "--partial") == 0) {
+        keepPartial = true;
+        first++;
+    }
+    if (argc - first < 2) {
+        std::cerr << "Usage: " << argv[0] << " [--partial] output.exr part0.exr [part1.exr ...]"
+                  << std::endl;
+        return 1;
+    }
+    const char* output = argv[first];
+
+    // Sums stay in double, and a pixel owned by a single shard is copied
+    // through unchanged, so a row-sharded merge reproduces the unsharded
+    // render exactly.
+    int width = 0, height = 0;
+    std::vector<Vec4> merged;
+    std::vector<double> sums;
+    std::vector<float> totals;
+    std::vector<int> owners;
+    std::vector<Vec4> pixels;
+    std::vector<float> counts;
+    for (int a = first + 1; a < argc; a++) {
+        int w, h;
+        if (!loadPartialEXR(argv[a], pixels, counts, w, h)) {
+            return 1;
+        }
+        if (merged.empty()) {
+            width = w;
+            height = h;
+            merged.assign(width * height, Vec4());
+            sums.assign(4 * width * height, 0.0);
+            totals.assign(width * height, 0.0f);
+            owners.assign(width * height, 0);
+        } else if (w != width || h != height) {
+            std::cerr << "Size mismatch: " << argv[a] << std::endl;
+            return 1;
+        }
+        for (int k = 0; k < width * height; k++) {
+            double n = counts[k];
+            if (n <= 0) continue;
+            if (owners[k] == 0) {
+                merged[k] = pixels[k];
+            }
+            double* sum = &sums[4 * k];
+            sum[0] += pixels[k].x * n;
+            sum[1] += pixels[k].y * n;
+            sum[2] += pixels[k].z * n;
+            sum[3] += pixels[k].w * n;
+            totals[k] += counts[k];
+            owners[k]++;
+        }
+    }
+
+    int missing = 0;
+    for (int k = 0; k < width * height; k++) {
+        if (owners[k] > 1) {
+            const double* sum = &sums[4 * k];
+            double n = totals[k];
+            merged[k] = Vec4(sum[0] / n, sum[1] / n, sum[2] / n, sum[3] / n);
+        } else if (owners[k] == 0) {
+            missing++;
+        }
+    }
+
+    if (keepPartial) {
+        savePartialEXR(merged, totals, width, height, output);
+        return 0;
+    }
+    if (missing > 0) {
+        std::cerr << missing << " pixels have no samples; pass every shard or use --partial"
+                  << std::endl;
+        return 1;
+    }
+    saveEXR(merged, width, height, output);
+    return 0;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <OpenEXR/ImfChannelList.h>
+#include <OpenEXR/ImfFrameBuffer.h>
+#include <OpenEXR/ImfHeader.h>
+#include <OpenEXR/ImfInputFile.h>
+#include <OpenEXR/ImfOutputFile.h>
+#include "vector.h"
+#include "profiler.h"
+
+// Partial renders are stored as full-float EXRs. R, G, B and A hold the mean
+// over the samples this shard took, and the extra "spp" channel holds the
+// per-pixel sample count (0 for pixels the shard does not own), so merging is
+// a sample-weighted average.
+
+void savePartialEXR(const std::vector<Vec4>& pixels, const std::vector<float>& sampleCounts,
+                    int width, int height, const char* filename) {
+    PROFILE_SCOPE("saveEXR");
+    Imf::Header header(width, height);
+    const char* names[4] = {"R", "G", "B", "A"};
+    for (const char* name : names) {
+        header.channels().insert(name, Imf::Channel(Imf::FLOAT));
+    }
+    header.channels().insert("spp", Imf::Channel(Imf::FLOAT));
+
+    Imf::FrameBuffer frameBuffer;
+    char* base = (char*)pixels.data();
+    size_t xStride = sizeof(Vec4);
+    size_t yStride = sizeof(Vec4) * width;
+    for (int c = 0; c < 4; c++) {
+        frameBuffer.insert(names[c], Imf::Slice(Imf::FLOAT, base + c * sizeof(float),
+                                                xStride, yStride));
+    }
+    frameBuffer.insert("spp", Imf::Slice(Imf::FLOAT, (char*)sampleCounts.data(),
+                                         sizeof(float), sizeof(float) * width));
+
+    try {
+        Imf::OutputFile file(filename, header);
+        file.setFrameBuffer(frameBuffer);
+        file.writePixels(height);
+        std::cout << "Saved partial EXR file: " << filename << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to save partial EXR file: " << e.what() << std::endl;
+    }
+}
+
+bool loadPartialEXR(const char* filename, std::vector<Vec4>& pixels,
+                    std::vector<float>& sampleCounts, int& width, int& height) {
+    try {
+        Imf::InputFile file(filename);
+        if (!file.header().channels().findChannel("spp")) {
+            std::cerr << "Not a partial render (no spp channel): " << filename << std::endl;
+            return false;
+        }
+        Imath::Box2i dw = file.header().dataWindow();
+        width = dw.max.x - dw.min.x + 1;
+        height = dw.max.y - dw.min.y + 1;
+        pixels.assign(width * height, Vec4());
+        sampleCounts.assign(width * height, 0.0f);
+
+        Imf::FrameBuffer frameBuffer;
+        char* base = (char*)pixels.data() - (dw.min.x + dw.min.y * width) * sizeof(Vec4);
+        size_t xStride = sizeof(Vec4);
+        size_t yStride = sizeof(Vec4) * width;
+        const char* names[4] = {"R", "G", "B", "A"};
+        for (int c = 0; c < 4; c++) {
+            frameBuffer.insert(names[c], Imf::Slice(Imf::FLOAT, base + c * sizeof(float),
+                                                    xStride, yStride));
+        }
+        char* countBase = (char*)sampleCounts.data()
+                          - (dw.min.x + dw.min.y * width) * sizeof(float);
+        frameBuffer.insert("spp", Imf::Slice(Imf::FLOAT, countBase,
+                                             sizeof(float), sizeof(float) * width));
+        file.setFrameBuffer(frameBuffer);
+        file.readPixels(dw.min.y, dw.max.y);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load partial EXR file: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
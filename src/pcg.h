@@ -7,7 +7,9 @@
 class UniformRandom {
 public:
     UniformRandom(uint64_t seed, float min, float max)
-        : rng(seed), float_min(min), float_max(max), is_float(true) {}
+        : rng(seed), is_float(true), float_min(min), float_max(max) {}
+    UniformRandom(uint64_t seed, uint64_t stream, float min, float max)
+        : rng(seed, stream), is_float(true), float_min(min), float_max(max) {}
 
     float next_float() {
         float zero_to_one = static_cast<float>(rng()) / static_cast<float>(pcg32::max());
@@ -20,4 +22,10 @@ private:
 
     float float_min;
     float float_max;
-};
\ No newline at end of file
+};
+
+// Independent stream per (pixel, sample), so any subset of pixels or samples
+// reproduces exactly what a full render would compute for them.
+inline UniformRandom pixelRandom(uint64_t seed, uint64_t pixel, uint64_t sample) {
+    return UniformRandom(seed + sample * 0x9E3779B97F4A7C15ULL, pixel, 0.0f, 1.0f);
+}
@@ -4,67 +4,67 @@
 #include <vector>
 #include <cmath>
 #include <numeric>
+#include "profiler.h"
+#include "bounded_array.h"
 
-float f_N(float p, const std::vector<float>& Y, const std::vector<float>& Q) {
-    int N = Y.size();
+// Upper bound on the number of comb estimates in one series. The roulette in
+// transEstimator reaches it with probability far below float precision, so
+// fixed-capacity stack buffers replace the per-call vectors.
+const int kMaxSeriesTerms = 64;
 
-    std::vector<float> shiftedY(N);
-    for (int i = 0; i < N; i++) {
-        shiftedY[i] = Y[i] - p;
+// The series needs the elementary symmetric polynomials e_1..e_N of the
+// shifted estimates. Expanding prod_j (1 + shiftedY[j] z) one factor at a
+// time yields them directly, without the alternating Newton-identity sums
+// over power sums that lose all precision in float as N grows. Accumulating
+// in double costs about the same as float here; see bench/series_precision.cpp.
+inline float f_N(float p, const float* Y, int N, const float* Q) {
+    double e[kMaxSeriesTerms + 1];
+    e[0] = 1.0;
+    for (int k = 1; k <= N; k++) {
+        e[k] = 0.0;
     }
-
-    std::vector<float> P(N);
-    for (int i = 0; i < N; i++) {
-        float sum = 0;
-        for (int j = 0; j < N; j++) {
-            sum += std::pow(shiftedY[j], (i + 1));
+    for (int j = 0; j < N; j++) {
+        double shiftedY = (double)Y[j] - p;
+        for (int k = j + 1; k >= 1; k--) {
+            e[k] += shiftedY * e[k-1];
         }
-        P[i] = sum;
     }
 
-    std::vector<float> S(N);
-    for (int i = 0; i < N; i++) {
-        float sum = 0;
-        int coef = 1;
-        for (int j = 0; j < i; j++) {
-            sum += coef * S[i-1-j] * P[j];
-            coef *= -1;
-        }
-        sum += coef * P[i];
-        S[i] = sum / (i + 1);
-    }
-
-    float f = 1.0f / Q[0];
-    float denom = 1.0f;
+    double f = 1.0 / Q[0];
+    double denom = 1.0;
     for (int i = 0; i < N; i++) {
         denom *= (N - i);
-        f += S[i] / (denom * Q[i+1]); 
+        f += e[i+1] / (denom * Q[i+1]);
     }
 
-    return std::exp(p) * f;
+    return (float)(std::exp((double)p) * f);
 }
 
-float compute_T(const std::vector<float>& X, const std::vector<float>& Q) {
-    int N_plus_1 = X.size();
-    int N = N_plus_1 - 1;
-
-    float T_sum = 0.0;
+inline float compute_T(const float* X, const float* Q, int N_plus_1) {
+    PROFILE_SCOPE("compute_T");
+    double T_sum = 0.0;
 
     for (int i = 0; i < N_plus_1; i++) {
         float p = X[i]; //pivot
 
-        std::vector<float> Y;
+        BoundedArray<float, kMaxSeriesTerms> Y;
         for (int j = 0; j < N_plus_1; ++j) {
             if (j != i) {
                 Y.push_back(X[j]);
             }
         }
 
-        float f = f_N(p, Y, Q);
-        T_sum += f;
+        T_sum += f_N(p, Y.data(), Y.size(), Q);
     }
 
     float T = T_sum / N_plus_1;
     return T;
 }
 
+inline float f_N(float p, const std::vector<float>& Y, const std::vector<float>& Q) {
+    return f_N(p, Y.data(), Y.size(), Q.data());
+}
+
+inline float compute_T(const std::vector<float>& X, const std::vector<float>& Q) {
+    return compute_T(X.data(), Q.data(), X.size());
+}
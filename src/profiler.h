@@ -0,0 +1,184 @@
+#pragma once
+
+// Scoped timeline instrumentation. Build with -DENABLE_PROFILING to record
+// spans; otherwise PROFILE_SCOPE and PROFILE_REPORT compile to nothing.
+
+#ifdef ENABLE_PROFILING
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Per-thread cap on full trace events. Aggregated stats keep counting after
+// the cap is hit, so the summary table stays exact.
+const size_t kMaxTraceEventsPerThread = 1 << 20;
+
+struct ProfileEvent {
+    const char* name;
+    int64_t start_ns;
+    int64_t end_ns;
+};
+
+struct ProfileStat {
+    const char* name;
+    uint64_t count;
+    int64_t total_ns;
+};
+
+struct ProfileThreadLog {
+    int tid;
+    uint64_t dropped = 0;
+    std::vector<ProfileEvent> events;
+    std::vector<ProfileStat> stats;
+};
+
+class Profiler {
+public:
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origin).count();
+    }
+
+    void record(const char* name, int64_t start_ns, int64_t end_ns) {
+        ProfileThreadLog& log = threadLog();
+
+        ProfileStat* stat = nullptr;
+        for (ProfileStat& s : log.stats) {
+            if (s.name == name) {
+                stat = &s;
+                break;
+            }
+        }
+        if (!stat) {
+            log.stats.push_back({name, 0, 0});
+            stat = &log.stats.back();
+        }
+        stat->count++;
+        stat->total_ns += end_ns - start_ns;
+
+        if (log.events.size() < kMaxTraceEventsPerThread) {
+            log.events.push_back({name, start_ns, end_ns});
+        } else {
+            log.dropped++;
+        }
+    }
+
+    void writeChromeTrace(const char* filename) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ofstream out(filename);
+        if (!out) {
+            std::cerr << "Failed to write trace file: " << filename << std::endl;
+            return;
+        }
+        out << "{\"traceEvents\":[\n";
+        bool first = true;
+        char line[256];
+        for (const auto& log : logs) {
+            for (const ProfileEvent& e : log->events) {
+                std::snprintf(line, sizeof(line),
+                              "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+                              "\"ts\":%.3f,\"dur\":%.3f}",
+                              first ? "" : ",\n", e.name, log->tid,
+                              e.start_ns / 1000.0, (e.end_ns - e.start_ns) / 1000.0);
+                out << line;
+                first = false;
+            }
+        }
+        out << "\n]}\n";
+        std::cout << "Saved trace file: " << filename << std::endl;
+    }
+
+    void printSummary() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<ProfileStat> merged;
+        uint64_t dropped = 0;
+        for (const auto& log : logs) {
+            dropped += log->dropped;
+            for (const ProfileStat& s : log->stats) {
+                auto it = std::find_if(merged.begin(), merged.end(),
+                                       [&](const ProfileStat& m) {
+                                           return std::strcmp(m.name, s.name) == 0;
+                                       });
+                if (it == merged.end()) {
+                    merged.push_back(s);
+                } else {
+                    it->count += s.count;
+                    it->total_ns += s.total_ns;
+                }
+            }
+        }
+        std::sort(merged.begin(), merged.end(),
+                  [](const ProfileStat& a, const ProfileStat& b) {
+                      return a.total_ns > b.total_ns;
+                  });
+
+        std::printf("%-20s %14s %14s %14s\n", "span", "calls", "total [ms]", "mean [us]");
+        for (const ProfileStat& s : merged) {
+            std::printf("%-20s %14llu %14.3f %14.3f\n", s.name,
+                        (unsigned long long)s.count, s.total_ns / 1e6,
+                        s.total_ns / 1e3 / s.count);
+        }
+        std::printf("threads: %zu, trace events dropped: %llu\n",
+                    logs.size(), (unsigned long long)dropped);
+    }
+
+private:
+    Profiler() : origin(std::chrono::steady_clock::now()) {}
+
+    ProfileThreadLog& threadLog() {
+        thread_local ProfileThreadLog* log = nullptr;
+        if (!log) {
+            std::lock_guard<std::mutex> lock(mutex);
+            logs.emplace_back(new ProfileThreadLog());
+            log = logs.back().get();
+            log->tid = logs.size() - 1;
+        }
+        return *log;
+    }
+
+    std::chrono::steady_clock::time_point origin;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ProfileThreadLog>> logs;
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : name(name), start_ns(Profiler::instance().now()) {}
+    ~ProfileScope() {
+        Profiler& profiler = Profiler::instance();
+        profiler.record(name, start_ns, profiler.now());
+    }
+
+private:
+    const char* name;
+    int64_t start_ns;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_REPORT(trace_file)                         \
+    do {                                                   \
+        Profiler::instance().printSummary();               \
+        Profiler::instance().writeChromeTrace(trace_file); \
+    } while (0)
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_REPORT(trace_file) ((void)0)
+
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+// Prints the progress bar from a background thread so render threads only
+// bump an atomic counter instead of writing and flushing stdout themselves.
+class ProgressReporter {
+public:
+    ProgressReporter(int total, int barWidth = 50)
+        : total(total), barWidth(barWidth), done(0), stopped(false),
+          startTime(std::chrono::steady_clock::now()),
+          worker(&ProgressReporter::run, this) {}
+
+    ~ProgressReporter() { finish(); }
+
+    void advance(int n = 1) { done.fetch_add(n, std::memory_order_relaxed); }
+
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopped) return;
+            stopped = true;
+        }
+        cv.notify_one();
+        worker.join();
+        print();
+        std::cout << std::endl;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopped) {
+            print();
+            cv.wait_for(lock, std::chrono::milliseconds(200));
+        }
+    }
+
+    void print() const {
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - startTime).count();
+        int current = done.load(std::memory_order_relaxed);
+
+        // Nothing to do (e.g. a shard that owns no rows) counts as complete.
+        float progress = total > 0 ? (float)current / total : 1.0f;
+        int pos = progress * barWidth;
+
+        std::cout << "\r[";
+        for (int i = 0; i < barWidth; ++i) {
+            if (i < pos) std::cout << "=";
+            else if (i == pos) std::cout << ">";
+            else std::cout << " ";
+        }
+        std::cout << "] " << int(progress * 100.0) << "% (" << current << "/" << total << ") "
+        << "Elapsed: " << elapsed << "s   " << std::flush;
+    }
+
+    int total;
+    int barWidth;
+    std::atomic<int> done;
+    bool stopped;
+    std::chrono::steady_clock::time_point startTime;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread worker;
+};
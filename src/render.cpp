@@ -0,0 +1,502 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "profiler.h"
+#define ALLOC_TRACKER_IMPLEMENTATION
+#include "alloc_tracker.h"
+#include "progress.h"
+#include "render_args.h"
+#include "checkpoint.h"
+#include "vector.h"
+#include "FastNoiseLite.h"
+#include "save_exr.h"
+#include "partial_exr.h"
+#include "estimate_trans.h"
+#include "radial_table.h"
+#include "pcg.h"
+#include "denoise.h"
+#include "lights.h"
+#include "temporal.h"
+#include "scene.h"
+
+Scene scene;
+FastNoiseLite noiseGen;
+LightSampler lightSampler;
+float (*density)(const Vec3) = nullptr;
+
+// Tabulated optical depth of the analytic spheres (--radial-table). When set,
+// power-series marches expand each segment's series about its tabulated depth.
+const RadialDepthTable* depthTable = nullptr;
+
+// Midpoint-rule subintervals per segment for the deterministic estimators:
+// one for exponential marching, kReferenceSubsteps for --estimator reference.
+const int kReferenceSubsteps = 32;
+int depthSubsteps = 1;
+
+// Sparse shadow sampling along primary rays (--shadow-stride) and the number
+// of shadow marches traced so far, reported per pixel.
+int shadowStride = 1;
+std::atomic<unsigned long long> shadowMarchCount(0);
+
+// Animation clock for --frames. The noise field drifts with the wind, so the
+// cloud changes shape over time while the sphere falloff stays put.
+float animationTime = 0.0f;
+
+void initNoise() {
+    noiseGen.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+    noiseGen.SetFractalType(FastNoiseLite::FractalType_FBm);
+    noiseGen.SetFractalOctaves(scene.noiseOctaves);
+    noiseGen.SetFrequency(scene.noiseFrequency);
+}
+
+float cloudDensity(const Vec3 p) {
+    Vec3 q = p - scene.wind * animationTime;
+    float baseNoise = noiseGen.GetNoise(q.x, q.y, q.z);
+    float d = std::max(0.0f, std::min((baseNoise + 1.0f) * 0.5f, 1.0f));
+
+    float dist = p.length();
+    float sphereFalloff = std::max(0.0f, std::min(1.0f - dist / scene.radius, 1.0f));
+
+    return d * sphereFalloff * scene.densityScale;
+}
+
+float homogeneousSphereDensity(const Vec3 p) {
+    float dist = p.length();
+    if (dist > scene.radius) return 0.0f;
+
+    return scene.densityScale;
+}
+
+float linearSphereDensity(const Vec3 p) {
+    float dist = p.length();
+    if (dist > scene.radius) return 0.0f;
+
+    return (1.0f - dist / scene.radius) * scene.densityScale;
+}
+
+Vec3 selfEmission(const Vec3& p) {
+    if (p.length() > scene.radius) return Vec3(0.0f, 0.0f, 0.0f);
+    return scene.emission;
+}
+
+// True when no point of the segment [start, start + dir * length] lies inside
+// the volume radius, so the march can skip it.
+bool segmentOutside(const Vec3& start, const Vec3& dir, float length) {
+    float s = std::max(0.0f, std::min(-dot(start, dir), length));
+    return (start + dir * s).length() > scene.radius;
+}
+
+// Optical depth of the segment [start, start + dir * length] by the midpoint
+// rule over depthSubsteps subintervals.
+float segmentDepth(const Vec3& start, const Vec3& dir, float length) {
+    float h = length / depthSubsteps;
+    float tau = 0.0f;
+    for (int k = 0; k < depthSubsteps; k++) {
+        tau += density(start + dir * ((k + 0.5f) * h));
+    }
+    return tau * h;
+}
+
+// Transmittance from point towards a light. Power-series renders pass an RNG
+// and estimate each segment without bias; deterministic renders integrate
+// each segment with segmentDepth().
+float shadow(const Vec3& point, const Vec3& lightDir, float lightDistance,
+             UniformRandom* float_rng) {
+    PROFILE_SCOPE("shadow_march");
+    shadowMarchCount.fetch_add(1, std::memory_order_relaxed);
+    float t = 0.0f;
+    float maxDist = std::min(1.5f * scene.radius, lightDistance);
+    float stepSize = scene.shadowStepSize;
+    float transmittance = 1.0f;
+    float tau = 0.0f;
+    float closestT = 0.0f;
+    RadialProfile profile;
+    if (float_rng && depthTable) {
+        profile = depthTable->alongRay(point, lightDir, closestT);
+    }
+
+    for (int i = 0; i < 100 && t < maxDist && transmittance > 0.01f; i++) {
+        Vec3 start_pos = point + lightDir * t;
+        if (segmentOutside(start_pos, lightDir, stepSize)) {
+            t += stepSize;
+            continue;
+        }
+        if (float_rng && depthTable) {
+            transmittance = transmittance
+                            * transEstimator(profile, closestT, point, lightDir,
+                                             t, t + stepSize, density, *float_rng);
+        } else if (float_rng) {
+            Vec3 end_pos = point + lightDir * (t + stepSize);
+            transmittance = transmittance
+                            * transEstimator(start_pos, end_pos, density, *float_rng);
+        } else {
+            tau += segmentDepth(start_pos, lightDir, stepSize);
+            transmittance = std::exp(-tau);
+        }
+        t += stepSize;
+    }
+    return transmittance;
+}
+
+float hgPhase(float cosTheta, float g) {
+    float denom = 1.0f + g * g - 2.0f * g * cosTheta;
+    return (1.0f - g * g) / (4.0f * M_PI * denom * std::sqrt(denom));
+}
+
+Vec3 lightContribution(const Light& light, const Vec3& p, const Vec3& rayDir,
+                       UniformRandom* float_rng, float pdf) {
+    float lightDistance;
+    Vec3 lightDir = light.directionFrom(p, lightDistance);
+    float cosTheta = dot(rayDir, lightDir);
+    float phase = hgPhase(cosTheta, scene.phaseG);
+    return shadow(p, lightDir, lightDistance, float_rng) * scene.sigmaS * phase
+           / pdf * light.radianceAt(lightDistance);
+}
+
+// Power-series renders trace one shadow march per step towards a light picked
+// in proportion to its power, whatever the size of the rig, and divide by the
+// pick probability. Deterministic renders sum every light.
+Vec3 inScattering(const Vec3& p, const Vec3& rayDir, UniformRandom* float_rng) {
+    if (float_rng) {
+        float pdf;
+        const Light& light = lightSampler.sample(*float_rng, pdf);
+        return lightContribution(light, p, rayDir, float_rng, pdf);
+    }
+    Vec3 radiance(0.0f, 0.0f, 0.0f);
+    for (const Light& light : lightSampler.all()) {
+        radiance = radiance + lightContribution(light, p, rayDir, nullptr, 1.0f);
+    }
+    return radiance;
+}
+
+// Marches one primary ray over segments [t, t + stepSize] from scene.tMin.
+// Every estimator covers the same segments: without an RNG the march is
+// deterministic and integrates each segment with segmentDepth(); with one,
+// transEstimator gives an unbiased estimate of the segment's transmittance,
+// expanded about the tabulated depth when depthTable is set. Emission and
+// in-scattering are taken at the midpoint and weighted by the transmittance
+// up to the segment times the segment's opacity.
+Vec4 raymarch(const Vec3& rayOrigin, const Vec3& rayDir,
+              UniformRandom* float_rng, float* depth = nullptr) {
+    PROFILE_SCOPE("primary_march");
+    float stepSize = scene.stepSize;
+    float t = scene.tMin;
+
+    float transmittance = 1.0f;
+    Vec3 accumulatedColor(0.0f, 0.0f, 0.0f);
+    int steps = 0;
+
+    float depthSum = 0.0f;
+    float weightSum = 0.0f;
+
+    // With stride k only one in every k in-volume steps, at a random phase,
+    // evaluates inScattering() and its shadow march, and that step is weighted
+    // by k. Each step is still picked with probability 1/k, so the estimate
+    // stays unbiased while shadow marches per ray drop k-fold.
+    bool scatters = !lightSampler.all().empty();
+    int shadowPhase = 0;
+    if (float_rng && scatters && shadowStride > 1) {
+        shadowPhase = std::min((int)(float_rng->next_float() * shadowStride), shadowStride - 1);
+    }
+    int volumeSteps = 0;
+
+    float closestT = 0.0f;
+    RadialProfile profile;
+    if (float_rng && depthTable) {
+        profile = depthTable->alongRay(rayOrigin, rayDir, closestT);
+    }
+
+    while (t < scene.tMax && transmittance > scene.minTransmittance && steps < scene.maxSteps) {
+        Vec3 pos = rayOrigin + rayDir * t;
+        if (segmentOutside(pos, rayDir, stepSize)) {
+            t += stepSize;
+            steps++;
+            continue;
+        }
+
+        float midT = t + stepSize / 2;
+        Vec3 midPos = rayOrigin + rayDir * midT;
+        float estExp;
+        if (float_rng && depthTable) {
+            estExp = transEstimator(profile, closestT, rayOrigin, rayDir,
+                                    t, t + stepSize, density, *float_rng);
+        } else if (float_rng) {
+            Vec3 end_pos = rayOrigin + rayDir * (t + stepSize);
+            estExp = transEstimator(pos, end_pos, density, *float_rng);
+        } else {
+            estExp = std::exp(-segmentDepth(pos, rayDir, stepSize));
+        }
+
+        // The segment's estimate is independent of the transmittance before
+        // it, so the product stays unbiased for the power-series estimator.
+        float weight = transmittance * (1 - estExp);
+        transmittance = transmittance * estExp;
+        if (scene.emissive()) {
+            accumulatedColor = accumulatedColor + weight * selfEmission(midPos);
+        }
+        if (scatters && (volumeSteps + shadowStride - shadowPhase) % shadowStride == 0) {
+            accumulatedColor = accumulatedColor
+                               + weight * shadowStride * inScattering(midPos, rayDir, float_rng);
+        }
+        volumeSteps++;
+        depthSum += weight * midT;
+        weightSum += weight;
+
+        t += stepSize;
+        steps++;
+    }
+
+    if (depth) {
+        // Empty rays report their closest approach to the volume centre.
+        *depth = weightSum > 0.0f ? depthSum / weightSum : -dot(rayOrigin, rayDir);
+    }
+
+    return Vec4(accumulatedColor.x, accumulatedColor.y, accumulatedColor.z, 1.0f - transmittance);
+}
+
+// Traces one sample and composites it over the background.
+Vec3 shadeSample(const Camera& cam, const Vec3& rayDir, const RenderArgs& args,
+                 uint64_t pixel, uint64_t sample, float& alpha, float* depth = nullptr) {
+    Vec4 rawColor;
+    if (args.estimator == Estimator::PowerSeries) {
+        UniformRandom float_rng = pixelRandom(args.seed, pixel, sample);
+        rawColor = raymarch(cam.pos, rayDir, &float_rng, depth);
+    } else {
+        rawColor = raymarch(cam.pos, rayDir, nullptr, depth);
+    }
+    alpha = rawColor.w;
+    return Vec3(rawColor.x, rawColor.y, rawColor.z) * alpha + scene.background * (1.0f - alpha);
+}
+
+// Turntable render for --frames: the camera orbits its target while the noise
+// drifts. The first frame takes args.spp samples per pixel and later frames
+// take args.temporalSpp, blended with reprojected history capped at args.spp.
+int renderAnimation(const RenderArgs& args) {
+    const float frameTime = 1.0f / 24.0f;
+    int width = scene.width;
+    int height = scene.height;
+    float aspect = width / (float)height;
+    Vec3 offset = scene.cameraPos - scene.cameraTarget;
+
+    std::vector<Vec4> pixels(width * height);
+    TemporalHistory prev, next;
+    next.reset(width, height);
+    Camera prevCam;
+
+    std::string output(args.output);
+    size_t extPos = output.rfind('.');
+    std::string stem = output.substr(0, extPos);
+    std::string ext = extPos == std::string::npos ? ".exr" : output.substr(extPos);
+
+    for (int frame = 0; frame < args.frames; ++frame) {
+        PROFILE_SCOPE("frame");
+        animationTime = frame * frameTime;
+        float angle = 2.0f * M_PI * frame / args.frames;
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        Vec3 orbit(offset.x * c + offset.z * s, offset.y, -offset.x * s + offset.z * c);
+        Camera cam = Camera::lookAt(scene.cameraTarget + orbit, scene.cameraTarget, aspect);
+        int samples = frame == 0 ? args.spp : args.temporalSpp;
+        std::vector<TemporalStats> rowStats(height);
+        shadowMarchCount = 0;
+
+        ProgressReporter progress(height);
+        parallelFor(height, args.threads, [&](int j) {
+            PROFILE_SCOPE("tile");
+            for (int i = 0; i < width; ++i) {
+                ALLOCATION_FREE_SCOPE("pixel");
+                Vec3 rayDir = cam.rayDir(i, j, width, height);
+
+                Vec3 sum(0.0f, 0.0f, 0.0f);
+                float luminanceSqSum = 0.0f;
+                float depthSum = 0.0f;
+                for (int s = 0; s < samples; ++s) {
+                    float alpha, depth;
+                    Vec3 color = shadeSample(cam, rayDir, args, j * width + i,
+                                             ((uint64_t)frame << 32) | s, alpha, &depth);
+                    sum = sum + color;
+                    float l = luminance(color);
+                    luminanceSqSum += l * l;
+                    depthSum += depth;
+                }
+                float inv = 1.0f / samples;
+                Vec3 finalColor = temporalResolve(prev, prevCam, cam, i, j, sum * inv,
+                                                  luminanceSqSum * inv, samples, depthSum * inv,
+                                                  args.spp, next, rowStats[j]);
+                pixels[j * width + i] = Vec4(finalColor.x, finalColor.y, finalColor.z, 1.0f);
+            }
+            progress.advance();
+        });
+        progress.finish();
+
+        TemporalStats stats;
+        for (const TemporalStats& row : rowStats) {
+            stats.reused += row.reused;
+            stats.rejected += row.rejected;
+        }
+
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "_%04d", frame);
+        saveEXR(pixels, width, height, (stem + suffix + ext).c_str());
+        std::cout << "Frame " << frame << ": " << samples << " spp, "
+                  << stats.reused << " pixels reused history, "
+                  << stats.rejected << " rejected, "
+                  << (double)shadowMarchCount / (width * height)
+                  << " shadow marches per pixel" << std::endl;
+
+        std::swap(prev, next);
+        next.reset(width, height);
+        prevCam = cam;
+    }
+
+    PROFILE_REPORT("trace.json");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        std::cerr << "Usage: " << argv[0] << " scene.txt [options]" << std::endl;
+        return 1;
+    }
+    std::vector<std::string> sceneOptions;
+    if (!loadScene(argv[1], scene, sceneOptions)) {
+        return 1;
+    }
+    // Options from the scene file come first, so the command line overrides them.
+    std::vector<char*> optionArgs = {argv[0]};
+    for (std::string& option : sceneOptions) {
+        optionArgs.push_back(&option[0]);
+    }
+    optionArgs.insert(optionArgs.end(), argv + 2, argv + argc);
+    RenderArgs args = parseRenderArgs(optionArgs.size(), optionArgs.data());
+    args.scene = argv[1];
+
+    switch (scene.density) {
+    case DensityModel::Cloud:
+        density = cloudDensity;
+        break;
+    case DensityModel::HomogeneousSphere:
+        density = homogeneousSphereDensity;
+        break;
+    case DensityModel::LinearSphere:
+        density = linearSphereDensity;
+        break;
+    }
+    initNoise();
+
+    if (args.lights && !loadLights(args.lights, scene.lights)) {
+        return 1;
+    }
+    if (!scene.lights.empty()) {
+        lightSampler.build(scene.lights);
+    }
+    shadowStride = args.shadowStride;
+    std::unique_ptr<RadialDepthTable> radialTable;
+    if (args.radialTable) {
+        if (scene.density == DensityModel::Cloud) {
+            std::cerr << "--radial-table needs a radially symmetric density" << std::endl;
+            return 1;
+        }
+        radialTable = std::make_unique<RadialDepthTable>(density, scene.radius);
+        depthTable = radialTable.get();
+    }
+    if (args.estimator == Estimator::Reference) {
+        depthSubsteps = kReferenceSubsteps;
+    }
+
+    if (args.frames > 1) {
+        return renderAnimation(args);
+    }
+
+    const int width = scene.width;
+    const int height = scene.height;
+    std::vector<Vec4> pixels(width * height);
+    Camera cam = Camera::lookAt(scene.cameraPos, scene.cameraTarget, width / (float)height);
+
+    int progressBarWidth = 50;
+
+    std::vector<DenoiseGuide> guides(width * height);
+    int startRow = 0;
+    if (args.resume && !resumeCheckpoint(args, width, height, pixels, startRow, &guides)) {
+        return 1;
+    }
+    CheckpointWriter checkpoints(args, width, height);
+
+    int sampleBegin = args.shard.sampleBegin(args.spp);
+    int sampleEnd = args.shard.sampleEnd(args.spp);
+
+    ProgressReporter progress(args.shard.ownedRows(height), progressBarWidth);
+    progress.advance(args.shard.ownedRows(startRow));
+    {
+        PROFILE_SCOPE("frame");
+        // Rows go to the workers in order. A checkpoint covers the rows
+        // before the watermark, the first row not yet finished.
+        std::vector<char> rowDone(height, 0);
+        int watermark = startRow;
+        std::mutex watermarkMutex;
+        parallelFor(height - startRow, args.threads, [&](int k) {
+            int j = startRow + k;
+            if (args.shard.ownsRow(j)) {
+                PROFILE_SCOPE("tile");
+                for (int i = 0; i < width; ++i) {
+                    ALLOCATION_FREE_SCOPE("pixel");
+                    Vec3 rayDir = cam.rayDir(i, j, width, height);
+
+                    Vec3 finalColor(0.0f, 0.0f, 0.0f);
+                    float luminanceMean = 0.0f;
+                    float luminanceM2 = 0.0f;
+                    float alphaSum = 0.0f;
+                    for (int s = sampleBegin; s < sampleEnd; ++s) {
+                        float alpha;
+                        Vec3 color = shadeSample(cam, rayDir, args, j * width + i, s, alpha);
+                        finalColor = finalColor + color;
+                        // Welford update; E[x^2] - E[x]^2 cancels badly in float.
+                        float l = luminance(color);
+                        float delta = l - luminanceMean;
+                        luminanceMean += delta / (s - sampleBegin + 1);
+                        luminanceM2 += delta * (l - luminanceMean);
+                        alphaSum += alpha;
+                    }
+                    int n = sampleEnd - sampleBegin;
+                    finalColor = finalColor * (1.0f / n);
+                    // Unbiased variance of the mean: M2 / (n - 1) per sample, over n.
+                    float meanVariance = n > 1 ? luminanceM2 / ((float)n * (n - 1)) : 0.0f;
+                    guides[j * width + i] = {meanVariance, alphaSum / n};
+                    pixels[j * width + i] = Vec4(finalColor.x, finalColor.y, finalColor.z, 1.0f);
+                }
+                progress.advance();
+            }
+            std::lock_guard<std::mutex> lock(watermarkMutex);
+            rowDone[j] = 1;
+            while (watermark < height && rowDone[watermark]) {
+                watermark++;
+            }
+            checkpoints.maybeSave(watermark, pixels, &guides);
+        });
+    }
+    progress.finish();
+
+    int renderedPixels = (args.shard.ownedRows(height) - args.shard.ownedRows(startRow)) * width;
+    if (!scene.lights.empty() && renderedPixels > 0) {
+        std::cout << "Shadow marches per pixel: "
+                  << (double)shadowMarchCount / renderedPixels << std::endl;
+    }
+
+    if (args.denoise) {
+        denoiseATrous(pixels, guides, width, height, 5, args.threads);
+    }
+
+    if (args.shard.isPartial()) {
+        savePartialEXR(pixels, shardSampleCounts(args.shard, width, height, args.spp),
+                       width, height, args.output);
+    } else {
+        saveEXR(pixels, width, height, args.output);
+    }
+    PROFILE_REPORT("trace.json");
+    return 0;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include "shard.h"
+
+// Exponential marching is the deterministic baseline; the power-series
+// estimator is unbiased. Reference marches the same segments as both but
+// integrates each segment's optical depth finely, giving the exact
+// transmittance the power-series estimator is unbiased for.
+enum class Estimator { Exponential, PowerSeries, Reference };
+
+struct RenderArgs {
+    // Scene file the render was started from; set by the renderer.
+    const char* scene = nullptr;
+    int spp = 1;
+    uint64_t seed = 42;
+    const char* output = "output.exr";
+    const char* checkpoint = nullptr;
+    double checkpointInterval = 60.0;
+    bool resume = false;
+    ShardSpec shard;
+    int frames = 1;
+    int temporalSpp = 0;
+    const char* lights = nullptr;
+    bool denoise = false;
+    int shadowStride = 1;
+    bool radialTable = false;
+    Estimator estimator = Estimator::PowerSeries;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+// Parses `--spp N --seed S --output path --checkpoint path
+// --checkpoint-interval seconds --resume --shard i/n --shard-mode rows|samples
+// --frames N --temporal-spp M --lights file --denoise --shadow-stride k
+// --radial-table --estimator exponential|power|reference --threads N`;
+// unspecified options keep defaults.
+RenderArgs parseRenderArgs(int argc, char** argv) {
+    RenderArgs args;
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (std::strcmp(argv[i], "--spp") == 0 && value) {
+            args.spp = std::max(1, std::atoi(value));
+            i++;
+        } else if (std::strcmp(argv[i], "--seed") == 0 && value) {
+            args.seed = std::strtoull(value, nullptr, 10);
+            i++;
+        } else if (std::strcmp(argv[i], "--output") == 0 && value) {
+            args.output = value;
+            i++;
+        } else if (std::strcmp(argv[i], "--checkpoint") == 0 && value) {
+            args.checkpoint = value;
+            i++;
+        } else if (std::strcmp(argv[i], "--checkpoint-interval") == 0 && value) {
+            args.checkpointInterval = std::atof(value);
+            i++;
+        } else if (std::strcmp(argv[i], "--resume") == 0) {
+            args.resume = true;
+        } else if (std::strcmp(argv[i], "--shard") == 0 && value && parseShard(value, args.shard)) {
+            i++;
+        } else if (std::strcmp(argv[i], "--shard-mode") == 0 && value &&
+                   (std::strcmp(value, "rows") == 0 || std::strcmp(value, "samples") == 0)) {
+            args.shard.bySamples = std::strcmp(value, "samples") == 0;
+            i++;
+        } else if (std::strcmp(argv[i], "--frames") == 0 && value) {
+            args.frames = std::max(1, std::atoi(value));
+            i++;
+        } else if (std::strcmp(argv[i], "--temporal-spp") == 0 && value) {
+            args.temporalSpp = std::max(1, std::atoi(value));
+            i++;
+        } else if (std::strcmp(argv[i], "--lights") == 0 && value) {
+            args.lights = value;
+            i++;
+        } else if (std::strcmp(argv[i], "--denoise") == 0) {
+            args.denoise = true;
+        } else if (std::strcmp(argv[i], "--shadow-stride") == 0 && value) {
+            args.shadowStride = std::max(1, std::atoi(value));
+            i++;
+        } else if (std::strcmp(argv[i], "--radial-table") == 0) {
+            args.radialTable = true;
+        } else if (std::strcmp(argv[i], "--estimator") == 0 && value &&
+                   (std::strcmp(value, "exponential") == 0 || std::strcmp(value, "power") == 0 ||
+                    std::strcmp(value, "reference") == 0)) {
+            args.estimator = std::strcmp(value, "power") == 0     ? Estimator::PowerSeries
+                             : std::strcmp(value, "reference") == 0 ? Estimator::Reference
+                                                                    : Estimator::Exponential;
+            i++;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && value) {
+            args.threads = std::max(1, std::atoi(value));
+            i++;
+        } else {
+            std::cerr << "Unknown or incomplete option: " << argv[i] << std::endl;
+            std::cerr << "Usage: " << argv[0]
+                      << " [--spp N] [--seed S] [--output file.exr]"
+                      << " [--checkpoint file] [--checkpoint-interval seconds] [--resume]"
+                      << " [--shard i/n] [--shard-mode rows|samples]"
+                      << " [--frames N] [--temporal-spp M] [--lights file] [--denoise]"
+                      << " [--shadow-stride k] [--radial-table]"
+                      << " [--estimator exponential|power|reference] [--threads N]"
+                      << std::endl;
+            std::exit(1);
+        }
+    }
+    if (args.resume && !args.checkpoint) {
+        std::cerr << "--resume requires --checkpoint" << std::endl;
+        std::exit(1);
+    }
+    if (args.shard.bySamples && args.spp < args.shard.count) {
+        std::cerr << "--shard-mode samples needs spp >= shard count" << std::endl;
+        std::exit(1);
+    }
+    if (args.frames > 1 && (args.checkpoint || args.shard.isPartial())) {
+        std::cerr << "--frames cannot be combined with --checkpoint or --shard" << std::endl;
+        std::exit(1);
+    }
+    if (args.denoise && args.shard.isPartial()) {
+        std::cerr << "--denoise needs the whole image and cannot be combined with --shard"
+                  << std::endl;
+        std::exit(1);
+    }
+    if (args.denoise && args.frames > 1) {
+        std::cerr << "--denoise is not supported with --frames" << std::endl;
+        std::exit(1);
+    }
+    if (args.denoise && args.spp < 2) {
+        std::cerr << "--denoise needs --spp 2 or more for per-pixel variance" << std::endl;
+        std::exit(1);
+    }
+    if (args.estimator != Estimator::PowerSeries && args.shadowStride > 1) {
+        std::cerr << "--shadow-stride needs --estimator power" << std::endl;
+        std::exit(1);
+    }
+    if (args.estimator != Estimator::PowerSeries && args.radialTable) {
+        std::cerr << "--radial-table needs --estimator power" << std::endl;
+        std::exit(1);
+    }
+    if (args.temporalSpp == 0) {
+        args.temporalSpp = std::max(1, args.spp / 4);
+    }
+    return args;
+}
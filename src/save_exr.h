@@ -7,8 +7,10 @@
 #include <OpenEXR/ImfRgba.h>
 #include <OpenEXR/ImfArray.h>
 #include "vector.h"
+#include "profiler.h"
 
 void saveEXR(const std::vector<Vec4>& pixels, int width, int height, const char* filename) {
+    PROFILE_SCOPE("saveEXR");
     Imf::Array2D<Imf::Rgba> exrPixels;
     exrPixels.resizeErase(height, width);
 
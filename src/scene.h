@@ -0,0 +1,145 @@
+#pragma once
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "vector.h"
+#include "lights.h"
+
+// Cloud is FBm noise under a linear falloff to zero at the radius. The
+// spheres are homogeneous or fall off linearly from the centre. Every model
+// is zero outside the radius.
+enum class DensityModel { Cloud, HomogeneousSphere, LinearSphere };
+
+struct Scene {
+    DensityModel density = DensityModel::Cloud;
+    float radius = 2.0f;
+    float densityScale = 1.0f;
+    int noiseOctaves = 5;
+    float noiseFrequency = 0.5f;
+    // The cloud noise drifts with the wind in animations.
+    Vec3 wind = Vec3(0.3f, 0.05f, 0.1f);
+
+    // Self-emission inside the radius, and single scattering of the lights
+    // with a Henyey-Greenstein phase function. A scene without lights does
+    // not trace shadow rays.
+    Vec3 emission;
+    std::vector<Light> lights;
+    float sigmaS = 1.0f;
+    float phaseG = 0.2f;
+
+    int width = 128;
+    int height = 128;
+    Vec3 cameraPos = Vec3(0.0f, 0.0f, -3.0f);
+    Vec3 cameraTarget = Vec3(0.0f, 0.0f, 0.0f);
+    Vec3 background = Vec3(0.5f, 0.7f, 1.0f);
+
+    float tMin = 0.0f;
+    float tMax = 5.0f;
+    float stepSize = 0.02f;
+    float shadowStepSize = 0.02f;
+    int maxSteps = 512;
+    float minTransmittance = 0.001f;
+
+    bool emissive() const {
+        return emission.x != 0.0f || emission.y != 0.0f || emission.z != 0.0f;
+    }
+};
+
+// Reads a scene description, one setting per line:
+//   density cloud|homogeneous|linear     radius R          density-scale s
+//   noise-octaves N    noise-frequency f    wind x y z
+//   emission r g b     light directional|point x y z r g b   (repeatable)
+//   sigma-s s          phase-g g
+//   resolution W H     camera px py pz tx ty tz     background r g b
+//   t-min t   t-max t   step h   shadow-step h   max-steps N   min-transmittance T
+// Any other key is a render option and is appended to options as
+// "--key value...", so `spp 16` in the file reads like `--spp 16` on the
+// command line. Blank lines and lines starting with '#' are ignored.
+bool loadScene(const char* filename, Scene& scene, std::vector<std::string>& options) {
+    std::ifstream in(filename);
+    if (!in) {
+        std::cerr << "Failed to open scene: " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key) || key[0] == '#') continue;
+
+        bool ok = true;
+        if (key == "density") {
+            std::string model;
+            fields >> model;
+            if (model == "cloud") {
+                scene.density = DensityModel::Cloud;
+            } else if (model == "homogeneous") {
+                scene.density = DensityModel::HomogeneousSphere;
+            } else if (model == "linear") {
+                scene.density = DensityModel::LinearSphere;
+            } else {
+                ok = false;
+            }
+        } else if (key == "radius") {
+            ok = !!(fields >> scene.radius);
+        } else if (key == "density-scale") {
+            ok = !!(fields >> scene.densityScale);
+        } else if (key == "noise-octaves") {
+            ok = !!(fields >> scene.noiseOctaves);
+        } else if (key == "noise-frequency") {
+            ok = !!(fields >> scene.noiseFrequency);
+        } else if (key == "wind") {
+            ok = !!(fields >> scene.wind.x >> scene.wind.y >> scene.wind.z);
+        } else if (key == "emission") {
+            ok = !!(fields >> scene.emission.x >> scene.emission.y >> scene.emission.z);
+        } else if (key == "light") {
+            std::string type;
+            Light light;
+            ok = (fields >> type) && parseLight(type, fields, light);
+            if (ok) scene.lights.push_back(light);
+        } else if (key == "sigma-s") {
+            ok = !!(fields >> scene.sigmaS);
+        } else if (key == "phase-g") {
+            ok = !!(fields >> scene.phaseG);
+        } else if (key == "resolution") {
+            ok = (fields >> scene.width >> scene.height) && scene.width > 0 && scene.height > 0;
+        } else if (key == "camera") {
+            ok = !!(fields >> scene.cameraPos.x >> scene.cameraPos.y >> scene.cameraPos.z
+                           >> scene.cameraTarget.x >> scene.cameraTarget.y >> scene.cameraTarget.z);
+        } else if (key == "background") {
+            ok = !!(fields >> scene.background.x >> scene.background.y >> scene.background.z);
+        } else if (key == "t-min") {
+            ok = !!(fields >> scene.tMin);
+        } else if (key == "t-max") {
+            ok = !!(fields >> scene.tMax);
+        } else if (key == "step") {
+            ok = (fields >> scene.stepSize) && scene.stepSize > 0.0f;
+        } else if (key == "shadow-step") {
+            ok = (fields >> scene.shadowStepSize) && scene.shadowStepSize > 0.0f;
+        } else if (key == "max-steps") {
+            ok = !!(fields >> scene.maxSteps);
+        } else if (key == "min-transmittance") {
+            ok = !!(fields >> scene.minTransmittance);
+        } else {
+            options.push_back("--" + key);
+            std::string value;
+            while (fields >> value) {
+                options.push_back(value);
+            }
+        }
+        if (!ok) {
+            std::cerr << filename << ":" << lineNumber << ": invalid " << key << std::endl;
+            return false;
+        }
+    }
+    if (!scene.lights.empty() && !rigHasPower(scene.lights)) {
+        std::cerr << filename << ": no light has positive luminance" << std::endl;
+        return false;
+    }
+    return true;
+}
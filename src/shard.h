@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+// Which part of a frame this process renders. In row mode, shard i of n
+// owns every row j with j % n == i, at the full sample count. Interleaving
+// keeps dense regions spread over all shards. In sample mode every shard
+// owns all pixels and renders samples [begin, end) of spp.
+struct ShardSpec {
+    int index = 0;
+    int count = 1;
+    bool bySamples = false;
+
+    bool isPartial() const { return count > 1; }
+    bool ownsRow(int j) const { return bySamples || j % count == index; }
+    int sampleBegin(int spp) const { return bySamples ? (long long)spp * index / count : 0; }
+    int sampleEnd(int spp) const { return bySamples ? (long long)spp * (index + 1) / count : spp; }
+
+    int ownedRows(int height) const {
+        int rows = 0;
+        for (int j = 0; j < height; j++) {
+            if (ownsRow(j)) rows++;
+        }
+        return rows;
+    }
+};
+
+// Parses "i/n" with 0 <= i < n.
+bool parseShard(const char* text, ShardSpec& shard) {
+    int index, count;
+    char tail;
+    if (std::sscanf(text, "%d/%d%c", &index, &count, &tail) != 2 ||
+        count < 1 || index < 0 || index >= count) {
+        return false;
+    }
+    shard.index = index;
+    shard.count = count;
+    return true;
+}
+
+// Per-pixel sample counts for a partial render, as stored in its spp channel.
+std::vector<float> shardSampleCounts(const ShardSpec& shard, int width, int height, int spp) {
+    std::vector<float> counts(width * height, 0.0f);
+    float owned = shard.sampleEnd(spp) - shard.sampleBegin(spp);
+    for (int j = 0; j < height; j++) {
+        if (!shard.ownsRow(j)) continue;
+        for (int i = 0; i < width; i++) {
+            counts[j * width + i] = owned;
+        }
+    }
+    return counts;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "vector.h"
+
+// Pinhole camera matching the renderers' convention: pixel (i, j) maps to
+// u = ((i / width) * 2 - 1) * aspect, v = (j / height) * 2 - 1 on the plane
+// one unit along forward.
+struct Camera {
+    Vec3 pos;
+    Vec3 right;
+    Vec3 up;
+    Vec3 forward;
+    float aspect;
+
+    static Camera lookAt(const Vec3& pos, const Vec3& target, float aspect) {
+        Camera cam;
+        cam.pos = pos;
+        cam.forward = (target - pos).normalized();
+        cam.right = cross(Vec3(0.0f, 1.0f, 0.0f), cam.forward).normalized();
+        cam.up = cross(cam.forward, cam.right);
+        cam.aspect = aspect;
+        return cam;
+    }
+
+    Vec3 rayDir(int i, int j, int width, int height) const {
+        float u = ((i / (float)width) * 2.0f - 1.0f) * aspect;
+        float v = (j / (float)height) * 2.0f - 1.0f;
+        return (right * u + up * v + forward).normalized();
+    }
+
+    // Nearest pixel that sees world point p; false if p is behind the camera
+    // or off screen.
+    bool project(const Vec3& p, int width, int height, int& i, int& j) const {
+        Vec3 d = p - pos;
+        float z = dot(d, forward);
+        if (z <= 0.0f) return false;
+        float u = dot(d, right) / z;
+        float v = dot(d, up) / z;
+        i = (int)std::lround((u / aspect + 1.0f) * 0.5f * width);
+        j = (int)std::lround((v + 1.0f) * 0.5f * height);
+        return i >= 0 && i < width && j >= 0 && j < height;
+    }
+};
+
+// Per-pixel running moments carried from one frame to the next: the mean
+// colour and the mean squared luminance, which with luminance(mean) gives the
+// per-sample luminance variance. depth is the opacity-weighted distance along
+// the primary ray and is used to reproject the pixel into the next frame's
+// camera.
+struct TemporalHistory {
+    int width = 0;
+    int height = 0;
+    std::vector<Vec3> mean;
+    std::vector<float> luminanceSq;
+    std::vector<float> count;
+    std::vector<float> depth;
+
+    void reset(int w, int h) {
+        width = w;
+        height = h;
+        mean.assign(w * h, Vec3());
+        luminanceSq.assign(w * h, 0.0f);
+        count.assign(w * h, 0.0f);
+        depth.assign(w * h, 0.0f);
+    }
+};
+
+struct TemporalStats {
+    int reused = 0;
+    int rejected = 0;
+};
+
+// Blends this frame's samples for pixel (i, j) with the reprojected history.
+// History is dropped when the pixel was off screen or occluded last frame, or
+// when the new mean lies outside a confidence band built from both variances,
+// which is how changes in the animated volume show up. History is capped at
+// maxSamples so stale lighting fades out. Returns the resolved colour and
+// writes the pixel's new entry into next.
+Vec3 temporalResolve(const TemporalHistory& prev, const Camera& prevCam, const Camera& cam,
+                     int i, int j, const Vec3& sampleMean, float sampleLuminanceSq,
+                     int samples, float depth, float maxSamples,
+                     TemporalHistory& next, TemporalStats& stats) {
+    const float kRejectSigma = 3.0f;
+    const float kDepthTolerance = 0.25f;
+    const float kVarianceFloor = 1e-4f;
+
+    int k = j * next.width + i;
+    Vec3 rayDir = cam.rayDir(i, j, next.width, next.height);
+    Vec3 worldPos = cam.pos + rayDir * depth;
+
+    Vec3 mean = sampleMean;
+    float luminanceSq = sampleLuminanceSq;
+    float count = samples;
+
+    int pi, pj;
+    if (!prev.count.empty() && prevCam.project(worldPos, prev.width, prev.height, pi, pj)) {
+        int pk = pj * prev.width + pi;
+        float histCount = std::min(prev.count[pk], maxSamples - samples);
+        float prevDepth = (worldPos - prevCam.pos).length();
+        bool visible = std::fabs(prev.depth[pk] - prevDepth) < kDepthTolerance;
+
+        if (histCount > 0.0f && visible) {
+            float histMean = luminance(prev.mean[pk]);
+            float histVar = std::max(prev.luminanceSq[pk] - histMean * histMean, 0.0f);
+            float newMean = luminance(sampleMean);
+            float newVar = std::max(sampleLuminanceSq - newMean * newMean, 0.0f);
+            // A single sample carries no variance estimate of its own.
+            if (samples < 2) newVar = histVar;
+            float sigma = std::sqrt((histVar + kVarianceFloor) / histCount
+                                    + (newVar + kVarianceFloor) / samples);
+
+            if (std::fabs(newMean - histMean) <= kRejectSigma * sigma) {
+                float total = histCount + samples;
+                mean = (prev.mean[pk] * histCount + sampleMean * (float)samples) * (1.0f / total);
+                luminanceSq = (prev.luminanceSq[pk] * histCount + sampleLuminanceSq * samples)
+                              / total;
+                count = total;
+                stats.reused++;
+            } else {
+                stats.rejected++;
+            }
+        }
+    }
+
+    next.mean[k] = mean;
+    next.luminanceSq[k] = luminanceSq;
+    next.count[k] = count;
+    next.depth[k] = depth;
+    return mean;
+}
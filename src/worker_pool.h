@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Process-wide pool behind parallelFor. Workers are started on first use and
+// kept for the rest of the run, so frames, row loops and denoiser passes
+// reuse the same threads instead of spawning a set per call.
+class WorkerPool {
+public:
+    static WorkerPool& shared() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Runs fn(k) for k in [0, count) on the calling thread and up to
+    // numThreads - 1 workers, handing out indices one at a time in order.
+    // Calls from several threads are serialized.
+    template <typename Fn>
+    void run(int count, int numThreads, Fn& fn) {
+        std::lock_guard<std::mutex> call(callMutex);
+        int helpers = std::max(0, std::min(numThreads, count) - 1);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while ((int)workers.size() < helpers) {
+                workers.emplace_back(&WorkerPool::workerLoop, this, (int)workers.size());
+            }
+            job.count = count;
+            job.helpers = helpers;
+            job.context = &fn;
+            job.invoke = [](void* context, int k) { (*static_cast<Fn*>(context))(k); };
+            next.store(0, std::memory_order_relaxed);
+            pending = helpers;
+            generation++;
+        }
+        wake.notify_all();
+
+        runIndices();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+    }
+
+private:
+    WorkerPool() : generation(0), stopping(false), pending(0), next(0) {}
+
+    struct Job {
+        int count = 0;
+        int helpers = 0;
+        void* context = nullptr;
+        void (*invoke)(void*, int) = nullptr;
+    };
+
+    void runIndices() {
+        int k;
+        while ((k = next.fetch_add(1, std::memory_order_relaxed)) < job.count) {
+            job.invoke(job.context, k);
+        }
+    }
+
+    void workerLoop(int index) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] {
+                    return stopping || (generation != seen && index < job.helpers);
+                });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+
+            runIndices();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+    uint64_t generation;
+    bool stopping;
+    int pending;
+    Job job;
+    std::atomic<int> next;
+    std::mutex callMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::vector<std::thread> workers;
+};
+
+// Runs fn(k) for k in [0, count) on numThreads threads, handing out indices
+// one at a time.
+template <typename Fn>
+void parallelFor(int count, int numThreads, Fn fn) {
+    WorkerPool::shared().run(count, numThreads, fn);
+}